@@ -50,6 +50,7 @@ public:
         bool               control;  ///< Is the Control key pressed?
         bool               shift;    ///< Is the Shift key pressed?
         bool               system;   ///< Is the System key pressed?
+        bool               repeat;   ///< Is this key_pressed generated by holding the key?
     };
 
     ////////////////////////////////////////////////////////////
@@ -71,6 +72,16 @@ public:
         int y; ///< Y position of the mouse pointer, relative to the top of the owner window
     };
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Raw mouse move event parameters (mouse_moved_raw)
+    ///
+    ////////////////////////////////////////////////////////////
+    struct mouse_move_raw_event
+    {
+        float delta_x; ///< Horizontal motion reported by the device, before acceleration
+        float delta_y; ///< Vertical motion reported by the device, before acceleration
+    };
+
     ////////////////////////////////////////////////////////////
     /// \brief mouse buttons events parameters
     ///        (mouse_button_pressed, mouse_button_released)
@@ -206,6 +217,9 @@ public:
 		///< The mouse cursor moved (data in event.mouse_move)
 		mouse_moved,
 
+		///< The mouse device reported a motion, see mouse::set_raw_motion_enabled (data in event.mouse_move_raw)
+		mouse_moved_raw,
+
 		///< The mouse cursor entered the area of the window (no data)
 		mouse_entered,
 
@@ -247,6 +261,7 @@ public:
     // Member data
     ////////////////////////////////////////////////////////////
     event_type type; ///< Type of the event
+    std::uint32_t time = 0; ///< Native time of the event in milliseconds (X server time), 0 if unknown
 
 	union
 	{
@@ -265,6 +280,9 @@ public:
 		///< mouse move event parameters (platform_event::mouse_moved)
 		mouse_move_event			mouse_move;
 
+		///< raw mouse move event parameters (platform_event::mouse_moved_raw)
+		mouse_move_raw_event		mouse_move_raw;
+
 		///< mouse button event parameters (platform_event::mouse_button_pressed, platform_event::mouse_button_released)
 		mouse_button_event			mouse_button;
 
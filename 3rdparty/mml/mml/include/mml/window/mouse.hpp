@@ -101,6 +101,46 @@ public:
     ///
     ////////////////////////////////////////////////////////////
     static void set_position(const std::array<std::int32_t, 2>& position, const window& relativeTo);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Check whether raw mouse motion is supported
+    ///
+    /// \return True if set_raw_motion_enabled can be used
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool is_raw_motion_available();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Enable or disable raw mouse motion
+    ///
+    /// While enabled, the focused window receives a mouse_moved_raw
+    /// event for each report of the mouse, at the device's own
+    /// rate, before pointer acceleration and without being
+    /// clamped to the screen. Disabled by default.
+    ///
+    /// \param enabled True to receive raw motion
+    ///
+    ////////////////////////////////////////////////////////////
+    static void set_raw_motion_enabled(bool enabled);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Get the position of the newest mouse motion of a
+    ///        window which has not been processed yet
+    ///
+    /// Unlike get_position, this never waits for the windowing
+    /// system: only the events already received are looked at,
+    /// and they are all left for the window to process. Useful to
+    /// sample the cursor as late as possible before a frame.
+    /// On Windows, it must be called from the thread owning the
+    /// window.
+    ///
+    /// \param relativeTo Reference window
+    /// \param position   Receives the position, in window coordinates
+    ///
+    /// \return True if a motion of the window was pending
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool latch_position(const window& relativeTo, std::array<std::int32_t, 2>& position);
 };
 
 } // namespace mml
@@ -31,6 +31,13 @@ class MML_WINDOW_API window : non_copyable
 {
 public:
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Function receiving the events of a window as soon
+    ///        as they are produced (see set_event_callback)
+    ///
+    ////////////////////////////////////////////////////////////
+    typedef void (*event_callback)(const platform_event& event, void* user_data);
+
     ////////////////////////////////////////////////////////////
     /// \brief Default constructor
     ///
@@ -205,6 +212,52 @@ public:
     ////////////////////////////////////////////////////////////
     bool wait_event(platform_event& event);
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Block until the OS has new events for any window
+    ///
+    /// The thread sleeps until the windowing system has events
+    /// pending, wake_up() is called or \a timeout_ms expires.
+    /// Events are not popped: call poll_event() on the windows
+    /// afterwards. On Linux, joystick input and hot-plug wake this
+    /// function too. Elsewhere joysticks and sensors don't, pass a
+    /// finite timeout if they have to be polled.
+    ///
+    /// \param timeout_ms Timeout in milliseconds, negative to wait forever
+    ///
+    /// \return True if events or a wake up arrived before the timeout
+    ///
+    /// \see wake_up
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool wait_for_events(std::int32_t timeout_ms);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Interrupt a thread blocked in wait_for_events
+    ///
+    /// This function can be called from any thread.
+    ///
+    /// \see wait_for_events
+    ///
+    ////////////////////////////////////////////////////////////
+    static void wake_up();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Deliver events to a callback instead of the event queue
+    ///
+    /// While a callback is set, events produced by the system are
+    /// handed over to it as soon as they are translated, on the
+    /// thread calling poll_event() or wait_event(), which then only
+    /// return events that were queued before the callback was set.
+    /// This saves queueing and copying every event when they are
+    /// forwarded to another queue anyway.
+    /// Pass a null callback to go back to queueing.
+    ///
+    /// \param callback  Function to call for every event, or null
+    /// \param user_data Pointer passed back to \a callback
+    ///
+    ////////////////////////////////////////////////////////////
+    void set_event_callback(event_callback callback, void* user_data = nullptr);
+
     ////////////////////////////////////////////////////////////
     /// \brief Get the position of the window
     ///
@@ -465,12 +518,21 @@ private:
     ////////////////////////////////////////////////////////////
     void initialize();
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Filter an event of the implementation and pass
+    ///        it on to the user's event callback
+    ///
+    ////////////////////////////////////////////////////////////
+    static void forward_event(const platform_event& event, void* user_data);
+
     ////////////////////////////////////////////////////////////
     // Member data
     ////////////////////////////////////////////////////////////
     priv::window_impl* impl_;           ///< Platform-specific implementation of the window
     std::array<std::uint32_t, 2> size_;           ///< Current size of the window
     bool visible_;
+    event_callback callback_;           ///< User's event callback, if any
+    void* callback_user_data_;          ///< Pointer passed back to callback_
 };
 
 } // namespace mml
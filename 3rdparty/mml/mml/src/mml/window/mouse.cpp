@@ -42,4 +42,25 @@ void mouse::set_position(const std::array<std::int32_t, 2>& position, const wind
     priv::input_impl::set_mouse_position(position, relativeTo);
 }
 
+
+////////////////////////////////////////////////////////////
+bool mouse::is_raw_motion_available()
+{
+    return priv::input_impl::is_raw_mouse_motion_available();
+}
+
+
+////////////////////////////////////////////////////////////
+void mouse::set_raw_motion_enabled(bool enabled)
+{
+    priv::input_impl::set_raw_mouse_motion_enabled(enabled);
+}
+
+
+////////////////////////////////////////////////////////////
+bool mouse::latch_position(const window& relativeTo, std::array<std::int32_t, 2>& position)
+{
+    return priv::input_impl::latch_mouse_position(relativeTo, position);
+}
+
 } // namespace mml
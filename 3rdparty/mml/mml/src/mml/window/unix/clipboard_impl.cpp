@@ -7,6 +7,7 @@
 
 #include <X11/Xatom.h>
 
+#include <atomic>
 #include <chrono>
 #include <vector>
 
@@ -18,6 +19,9 @@ Bool checkEvent(::Display*, XEvent* event, XPointer userData)
 	// Just check if the event matches the window
 	return event->xany.window == reinterpret_cast<::Window>(userData);
 }
+
+// Hidden window of the clipboard instance, 0 until the instance exists
+std::atomic<::Window> clipboardWindow(0);
 } // namespace
 
 namespace mml
@@ -43,6 +47,17 @@ void clipboard_impl::process_events()
 	get_instance().process_events_impl();
 }
 
+////////////////////////////////////////////////////////////
+void clipboard_impl::dispatch_event(XEvent& event)
+{
+	// Don't create the instance and its window for a stray event
+	const ::Window window = clipboardWindow.load();
+	if(!window || (event.xany.window != window))
+		return;
+
+	get_instance().process_event(event);
+}
+
 ////////////////////////////////////////////////////////////
 clipboard_impl::clipboard_impl()
 	: window_(0)
@@ -52,22 +67,26 @@ clipboard_impl::clipboard_impl()
 	display_ = open_display();
 
 	// Get the atoms we need to make use of the clipboard
-	clipboard_ = get_atom("CLIPBOARD", false);
-	targets_ = get_atom("TARGETS", false);
-	text_ = get_atom("TEXT", false);
-	utf8_string_ = get_atom("UTF8_STRING", true);
-	target_property_ = get_atom("SFML_CLIPBOARD_TARGET_PROPERTY", false);
+	clipboard_ = get_atom(atom::clipboard);
+	targets_ = get_atom(atom::targets);
+	text_ = get_atom(atom::text);
+	utf8_string_ = get_atom(atom::utf8_string);
+	target_property_ = get_atom(atom::clipboard_target_property);
 
 	// Create a hidden window that will broker our clipboard interactions with X
 	window_ = XCreateSimpleWindow(display_, DefaultRootWindow(display_), 0, 0, 1, 1, 0, 0, 0);
 
 	// Register the events we are interested in
 	XSelectInput(display_, window_, SelectionNotify | SelectionClear | SelectionRequest);
+
+	clipboardWindow = window_;
 }
 
 ////////////////////////////////////////////////////////////
 clipboard_impl::~clipboard_impl()
 {
+	clipboardWindow = 0;
+
 	// Destroy the window
 	if(window_)
 	{
@@ -198,7 +217,7 @@ void clipboard_impl::process_event(XEvent& windowEvent)
 				// We don't support INCR for now
 				// It is very unlikely that this will be returned
 				// for purely text data transfer anyway
-				if(type != get_atom("INCR", false))
+				if(type != get_atom(atom::incr))
 				{
 					// Only copy the data if the format is what we expect
 					if((type == utf8_string_) && (format == 8))
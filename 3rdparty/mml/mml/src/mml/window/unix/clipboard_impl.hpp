@@ -48,13 +48,23 @@ public:
 	////////////////////////////////////////////////////////////
 	/// \brief Process pending events for the hidden clipboard window
 	///
-	/// This function has to be called as part of normal window
-	/// event processing in order for our application to respond
-	/// to selection requests from other applications.
-	///
 	////////////////////////////////////////////////////////////
 	static void process_events();
 
+	////////////////////////////////////////////////////////////
+	/// \brief Process an event read by the window event dispatcher
+	///
+	/// The dispatcher hands over every event that doesn't belong
+	/// to a window, in order for our application to respond to
+	/// selection requests from other applications. Events of
+	/// other windows are ignored, and so are all events while
+	/// the clipboard hasn't been used yet.
+	///
+	/// \param event Event read from the display
+	///
+	////////////////////////////////////////////////////////////
+	static void dispatch_event(XEvent& event);
+
 private:
 	////////////////////////////////////////////////////////////
 	/// \brief Constructor
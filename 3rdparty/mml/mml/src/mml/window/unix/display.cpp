@@ -1,12 +1,18 @@
 ////////////////////////////////////////////////////////////
 // Headers
 ////////////////////////////////////////////////////////////
+#include <X11/XKBlib.h>
+#include <X11/Xlibint.h>
 #include <X11/keysym.h>
+#undef max
+#undef min
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 #include <map>
 #include <mml/system/err.hpp>
 #include <mml/window/unix/display.hpp>
+#include <mml/window/unix/event_loop.hpp>
 #include <mutex>
 
 namespace
@@ -15,10 +21,78 @@ namespace
 std::once_flag flag;
 Display* sharedDisplay = nullptr;
 unsigned int referenceCount = 0;
+bool detectableAutoRepeat = false;
 std::mutex mutex;
 
 typedef std::map<std::string, Atom> AtomMap;
 AtomMap atoms;
+std::mutex atomsMutex;
+
+// Must follow the order of mml::priv::atom::id
+const char* atomNames[] = {
+	"CLIPBOARD",
+	"INCR",
+	"SFML_CLIPBOARD_TARGET_PROPERTY",
+	"TARGETS",
+	"TEXT",
+	"UTF8_STRING",
+	"WM_DELETE_WINDOW",
+	"WM_PROTOCOLS",
+	"_MOTIF_WM_HINTS",
+	"_NET_ACTIVE_WINDOW",
+	"_NET_FRAME_EXTENTS",
+	"_NET_SUPPORTED",
+	"_NET_SUPPORTING_WM_CHECK",
+	"_NET_WM_BYPASS_COMPOSITOR",
+	"_NET_WM_ICON",
+	"_NET_WM_ICON_NAME",
+	"_NET_WM_NAME",
+	"_NET_WM_PID",
+	"_NET_WM_PING",
+	"_NET_WM_STATE",
+	"_NET_WM_STATE_ABOVE",
+	"_NET_WM_STATE_FOCUSED",
+	"_NET_WM_STATE_MAXIMIZED_HORZ",
+	"_NET_WM_STATE_MAXIMIZED_VERT",
+	"_NET_WM_STATE_SKIP_PAGER",
+	"_NET_WM_STATE_SKIP_TASKBAR",
+	"_NET_WM_USER_TIME",
+	"_NET_WM_WINDOW_OPACITY",
+	"_NET_WM_WINDOW_TYPE",
+	"_NET_WM_WINDOW_TYPE_NORMAL",
+	"_NET_WM_WINDOW_TYPE_POPUP_MENU",
+	"_NET_WM_WINDOW_TYPE_TOOLTIP",
+	"_NET_WM_WINDOW_TYPE_UTILITY",
+};
+static_assert(sizeof(atomNames) / sizeof(atomNames[0]) == mml::priv::atom::count, "Atom table mismatch");
+
+// Atoms live as long as the server, the table is filled once
+Atom atomTable[mml::priv::atom::count] = {};
+std::atomic<bool> atomTableLoaded(false);
+
+// Xlib converts each event it reads from the wire on the thread which read
+// it, whichever call that was. The original converters, by event type.
+typedef Bool (*WireToEventProc)(Display*, XEvent*, xEvent*);
+WireToEventProc wireToEvent[LASTEvent] = {};
+std::atomic<int> eventWaiters(0);
+
+Bool convertQueuedEvent(Display* display, XEvent* event, xEvent* wire)
+{
+	const Bool queued = wireToEvent[wire->u.u.type & 0x7f](display, event, wire);
+
+	if(queued && (eventWaiters.load() > 0))
+		mml::priv::wake_up_wait();
+
+	return queued;
+}
+
+// Only core events are hooked: extensions register their converters later
+// and replace the hook for their own events
+void hookEventQueue(Display* display)
+{
+	for(int type = KeyPress; type < LASTEvent; ++type)
+		wireToEvent[type] = XESetWireToEvent(display, type, convertQueuedEvent);
+}
 } // namespace
 
 namespace mml
@@ -44,6 +118,19 @@ Display* open_display()
 				  << std::endl;
 			std::abort();
 		}
+
+		// Don't send a fake KeyRelease before each repeated KeyPress
+		Bool supported = False;
+		XkbSetDetectableAutoRepeat(sharedDisplay, True, &supported);
+		detectableAutoRepeat = supported;
+
+		hookEventQueue(sharedDisplay);
+
+		if(!atomTableLoaded.load(std::memory_order_relaxed))
+		{
+			XInternAtoms(sharedDisplay, const_cast<char**>(atomNames), atom::count, False, atomTable);
+			atomTableLoaded.store(true, std::memory_order_release);
+		}
 	}
 
 	referenceCount++;
@@ -62,9 +149,46 @@ void close_display(Display* display)
 		XCloseDisplay(display);
 }
 
+////////////////////////////////////////////////////////////
+Display* get_persistent_display()
+{
+	static Display* display = open_display();
+	return display;
+}
+
+////////////////////////////////////////////////////////////
+void begin_event_wait()
+{
+	eventWaiters++;
+}
+
+////////////////////////////////////////////////////////////
+void end_event_wait()
+{
+	eventWaiters--;
+}
+
+////////////////////////////////////////////////////////////
+bool has_detectable_auto_repeat()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return detectableAutoRepeat;
+}
+
+////////////////////////////////////////////////////////////
+Atom get_atom(atom::id id)
+{
+	if(!atomTableLoaded.load(std::memory_order_acquire))
+		close_display(open_display());
+
+	return atomTable[id];
+}
+
 ////////////////////////////////////////////////////////////
 Atom get_atom(const std::string& name, bool onlyIfExists)
 {
+	std::lock_guard<std::mutex> lock(atomsMutex);
+
 	AtomMap::const_iterator iter = atoms.find(name);
 
 	if(iter != atoms.end())
@@ -30,9 +30,103 @@ Display* open_display();
 ////////////////////////////////////////////////////////////
 void close_display(Display* display);
 
+////////////////////////////////////////////////////////////
+/// \brief Get the shared Display for frequent queries
+///
+/// The reference taken by the first call is never released,
+/// so input queries don't lock nor touch the reference count.
+/// Xlib serializes requests on the connection itself.
+///
+/// \return Pointer to the shared display
+///
+////////////////////////////////////////////////////////////
+Display* get_persistent_display();
+
+////////////////////////////////////////////////////////////
+/// \brief Mark the calling thread as waiting for events of
+///        the shared display, or as done waiting
+///
+/// Xlib calls made by other threads can read events into
+/// Xlib's queue, which doesn't make the connection readable
+/// again. While a thread waits, each core event Xlib queues
+/// calls wake_up_wait. Events queued before begin_event_wait
+/// must be checked for with XPending after it.
+///
+////////////////////////////////////////////////////////////
+void begin_event_wait();
+
+////////////////////////////////////////////////////////////
+/// \brief Counterpart of begin_event_wait
+///
+////////////////////////////////////////////////////////////
+void end_event_wait();
+
+////////////////////////////////////////////////////////////
+/// \brief Atoms used by the backend, interned together when
+///        the display is first opened
+///
+////////////////////////////////////////////////////////////
+struct atom
+{
+	enum id
+	{
+		clipboard,
+		incr,
+		clipboard_target_property,
+		targets,
+		text,
+		utf8_string,
+		wm_delete_window,
+		wm_protocols,
+		motif_wm_hints,
+		net_active_window,
+		net_frame_extents,
+		net_supported,
+		net_supporting_wm_check,
+		net_wm_bypass_compositor,
+		net_wm_icon,
+		net_wm_icon_name,
+		net_wm_name,
+		net_wm_pid,
+		net_wm_ping,
+		net_wm_state,
+		net_wm_state_above,
+		net_wm_state_focused,
+		net_wm_state_maximized_horz,
+		net_wm_state_maximized_vert,
+		net_wm_state_skip_pager,
+		net_wm_state_skip_taskbar,
+		net_wm_user_time,
+		net_wm_window_opacity,
+		net_wm_window_type,
+		net_wm_window_type_normal,
+		net_wm_window_type_popup_menu,
+		net_wm_window_type_tooltip,
+		net_wm_window_type_utility,
+
+		count ///< Keep last -- the total number of atoms
+	};
+};
+
+////////////////////////////////////////////////////////////
+/// \brief Get one of the preloaded atoms
+///
+/// The table is filled with a single XInternAtoms round trip
+/// the first time the shared display is opened, lookups after
+/// that don't lock nor talk to the server.
+///
+/// \param id Atom to get
+///
+/// \return The atom
+///
+////////////////////////////////////////////////////////////
+Atom get_atom(atom::id id);
+
 ////////////////////////////////////////////////////////////
 /// \brief Get the atom with the specified name
 ///
+/// Slow path for atoms which are not in the preloaded table.
+///
 /// \param name         Name of the atom
 /// \param onlyIfExists Don't try to create the atom if it doesn't already exist
 ///
@@ -41,6 +135,19 @@ void close_display(Display* display);
 ////////////////////////////////////////////////////////////
 Atom get_atom(const std::string& name, bool onlyIfExists = false);
 
+////////////////////////////////////////////////////////////
+/// \brief Tell whether the server sends no KeyRelease for
+///        auto-repeated keys
+///
+/// Detectable auto-repeat is requested through XKB when the
+/// shared display is opened. Without it, a held key produces
+/// KeyRelease/KeyPress pairs which have to be filtered out.
+///
+/// \return True if detectable auto-repeat is active
+///
+////////////////////////////////////////////////////////////
+bool has_detectable_auto_repeat();
+
 } // namespace priv
 
 } // namespace mml
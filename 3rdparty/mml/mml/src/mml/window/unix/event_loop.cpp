@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <mml/config.hpp>
+#include <mml/system/err.hpp>
+#include <mml/window/unix/event_loop.hpp>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <mutex>
+#include <unistd.h>
+
+#if defined(MML_SYSTEM_LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#include <poll.h>
+#endif
+
+namespace
+{
+std::once_flag loopFlag;
+
+#if defined(MML_SYSTEM_LINUX)
+
+// One epoll instance waits for the display, the devices and the wake up eventfd
+int epollFd = -1;
+int wakeUpFd = -1;
+
+void createLoop()
+{
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	wakeUpFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if((epollFd < 0) || (wakeUpFd < 0))
+	{
+		mml::err() << "Failed to create the event loop" << std::endl;
+		return;
+	}
+
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = wakeUpFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeUpFd, &event);
+}
+
+#else
+
+// Self-pipe used to interrupt wait_for_fds from other threads
+int wakeUpPipe[2] = {-1, -1};
+
+void createLoop()
+{
+	if(pipe(wakeUpPipe) != 0)
+	{
+		mml::err() << "Failed to create the event wake up pipe" << std::endl;
+		wakeUpPipe[0] = wakeUpPipe[1] = -1;
+		return;
+	}
+
+	for(int fd : wakeUpPipe)
+	{
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+}
+
+#endif
+} // namespace
+
+namespace mml
+{
+namespace priv
+{
+#if defined(MML_SYSTEM_LINUX)
+
+////////////////////////////////////////////////////////////
+void watch_fd(int fd)
+{
+	std::call_once(loopFlag, createLoop);
+
+	if((epollFd < 0) || (fd < 0))
+		return;
+
+	epoll_event event = {};
+	event.events = EPOLLIN | EPOLLET;
+	event.data.fd = fd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+}
+
+////////////////////////////////////////////////////////////
+void unwatch_fd(int fd)
+{
+	if((epollFd < 0) || (fd < 0))
+		return;
+
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+////////////////////////////////////////////////////////////
+bool wait_for_fds(int displayFd, std::int32_t timeout_ms)
+{
+	std::call_once(loopFlag, createLoop);
+
+	if(epollFd < 0)
+		return false;
+
+	// The display can be closed and reopened, closing it removed the old
+	// descriptor from the set. Level-triggered, since Xlib reads it.
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = displayFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, displayFd, &event);
+
+	epoll_event events[16];
+	int count = 0;
+	do
+	{
+		count = epoll_wait(epollFd, events, 16, timeout_ms < 0 ? -1 : timeout_ms);
+	} while(count < 0 && errno == EINTR);
+
+	for(int i = 0; i < count; ++i)
+	{
+		if(events[i].data.fd == wakeUpFd)
+		{
+			std::uint64_t value;
+			ssize_t result = read(wakeUpFd, &value, sizeof(value));
+			(void)result;
+		}
+	}
+
+	return count > 0;
+}
+
+////////////////////////////////////////////////////////////
+void wake_up_wait()
+{
+	std::call_once(loopFlag, createLoop);
+
+	if(wakeUpFd >= 0)
+	{
+		// Never blocks: the counter only saturates after 2^64 - 2 wake ups
+		const std::uint64_t value = 1;
+		const ssize_t written = write(wakeUpFd, &value, sizeof(value));
+		(void)written;
+	}
+}
+
+#else
+
+////////////////////////////////////////////////////////////
+void watch_fd(int)
+{
+}
+
+////////////////////////////////////////////////////////////
+void unwatch_fd(int)
+{
+}
+
+////////////////////////////////////////////////////////////
+bool wait_for_fds(int displayFd, std::int32_t timeout_ms)
+{
+	std::call_once(loopFlag, createLoop);
+
+	pollfd fds[2] = {{displayFd, POLLIN, 0}, {wakeUpPipe[0], POLLIN, 0}};
+	const nfds_t count = wakeUpPipe[0] >= 0 ? 2 : 1;
+
+	int result = 0;
+	do
+	{
+		result = poll(fds, count, timeout_ms < 0 ? -1 : timeout_ms);
+	} while(result < 0 && errno == EINTR);
+
+	if(count > 1 && (fds[1].revents & POLLIN))
+	{
+		char buffer[64];
+		while(read(wakeUpPipe[0], buffer, sizeof(buffer)) > 0)
+		{
+		}
+	}
+
+	return result > 0;
+}
+
+////////////////////////////////////////////////////////////
+void wake_up_wait()
+{
+	std::call_once(loopFlag, createLoop);
+
+	if(wakeUpPipe[1] >= 0)
+	{
+		// Failing on a full pipe is fine, a wake up is already pending
+		const char byte = 0;
+		const ssize_t written = write(wakeUpPipe[1], &byte, 1);
+		(void)written;
+	}
+}
+
+#endif
+
+} // namespace priv
+
+} // namespace mml
@@ -0,0 +1,58 @@
+#ifndef MML_EVENTLOOP_HPP
+#define MML_EVENTLOOP_HPP
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+
+namespace mml
+{
+namespace priv
+{
+////////////////////////////////////////////////////////////
+/// \brief Make an input device wake up wait_for_fds
+///
+/// The descriptor is watched edge-triggered: a wait returns
+/// once when new data arrives, the device doesn't have to be
+/// drained to go back to sleep. Only supported on Linux,
+/// elsewhere devices still have to be polled.
+///
+/// \param fd Descriptor to watch
+///
+////////////////////////////////////////////////////////////
+void watch_fd(int fd);
+
+////////////////////////////////////////////////////////////
+/// \brief Stop watching a descriptor, before closing it
+///
+/// \param fd Descriptor passed to watch_fd
+///
+////////////////////////////////////////////////////////////
+void unwatch_fd(int fd);
+
+////////////////////////////////////////////////////////////
+/// \brief Block until the display connection or a watched
+///        device is readable, or wake_up_wait is called
+///
+/// \param displayFd  Connection number of the X display
+/// \param timeout_ms Timeout in milliseconds, negative to wait forever
+///
+/// \return True if something arrived before the timeout
+///
+////////////////////////////////////////////////////////////
+bool wait_for_fds(int displayFd, std::int32_t timeout_ms);
+
+////////////////////////////////////////////////////////////
+/// \brief Interrupt a thread blocked in wait_for_fds
+///
+/// This function can be called from any thread.
+///
+////////////////////////////////////////////////////////////
+void wake_up_wait();
+
+} // namespace priv
+
+} // namespace mml
+
+#endif // MML_EVENTLOOP_HPP
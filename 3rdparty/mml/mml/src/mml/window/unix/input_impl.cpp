@@ -7,6 +7,7 @@
 #include <mml/window/input_impl.hpp>
 #include <mml/window/unix/display.hpp>
 #include <mml/window/unix/keyboard_impl.hpp>
+#include <mml/window/unix/window_impl_x11.hpp>
 #include <mml/window/window.hpp>
 
 namespace mml
@@ -52,8 +53,8 @@ void input_impl::set_virtual_keyboard_visible(bool /*visible*/)
 ////////////////////////////////////////////////////////////
 bool input_impl::is_mouse_button_pressed(mouse::button button)
 {
-	// Open a connection with the X server
-	Display* display = open_display();
+	// The persistent connection skips the display mutex and reference count
+	Display* display = get_persistent_display();
 
 	// we don't care about these but they are required
 	::Window root, child;
@@ -63,9 +64,6 @@ bool input_impl::is_mouse_button_pressed(mouse::button button)
 	unsigned int buttons = 0;
 	XQueryPointer(display, DefaultRootWindow(display), &root, &child, &gx, &gy, &wx, &wy, &buttons);
 
-	// Close the connection with the X server
-	close_display(display);
-
 	switch(button)
 	{
 		case mouse::left:
@@ -88,8 +86,7 @@ bool input_impl::is_mouse_button_pressed(mouse::button button)
 ////////////////////////////////////////////////////////////
 std::array<std::int32_t, 2> input_impl::get_mouse_position()
 {
-	// Open a connection with the X server
-	Display* display = open_display();
+	Display* display = get_persistent_display();
 
 	// we don't care about these but they are required
 	::Window root, child;
@@ -100,9 +97,6 @@ std::array<std::int32_t, 2> input_impl::get_mouse_position()
 	int gy = 0;
 	XQueryPointer(display, DefaultRootWindow(display), &root, &child, &gx, &gy, &x, &y, &buttons);
 
-	// Close the connection with the X server
-	close_display(display);
-
 	return std::array<std::int32_t, 2>({{gx, gy}});
 }
 
@@ -112,8 +106,7 @@ std::array<std::int32_t, 2> input_impl::get_mouse_position(const window& relativ
 	window_handle handle = relativeTo.native_handle();
 	if(handle)
 	{
-		// Open a connection with the X server
-		Display* display = open_display();
+		Display* display = get_persistent_display();
 
 		// we don't care about these but they are required
 		::Window root, child;
@@ -124,9 +117,6 @@ std::array<std::int32_t, 2> input_impl::get_mouse_position(const window& relativ
 		int y = 0;
 		XQueryPointer(display, handle, &root, &child, &gx, &gy, &x, &y, &buttons);
 
-		// Close the connection with the X server
-		close_display(display);
-
 		return std::array<std::int32_t, 2>({{x, y}});
 	}
 	else
@@ -138,21 +128,17 @@ std::array<std::int32_t, 2> input_impl::get_mouse_position(const window& relativ
 ////////////////////////////////////////////////////////////
 void input_impl::set_mouse_position(const std::array<std::int32_t, 2>& position)
 {
-	// Open a connection with the X server
-	Display* display = open_display();
+	Display* display = get_persistent_display();
 
 	XWarpPointer(display, None, DefaultRootWindow(display), 0, 0, 0, 0, position[0], position[1]);
 	XFlush(display);
 
-	// Close the connection with the X server
-	close_display(display);
 }
 
 ////////////////////////////////////////////////////////////
 void input_impl::set_mouse_position(const std::array<std::int32_t, 2>& position, const window& relativeTo)
 {
-	// Open a connection with the X server
-	Display* display = open_display();
+	Display* display = get_persistent_display();
 
 	window_handle handle = relativeTo.native_handle();
 	if(handle)
@@ -161,8 +147,28 @@ void input_impl::set_mouse_position(const std::array<std::int32_t, 2>& position,
 		XFlush(display);
 	}
 
-	// Close the connection with the X server
-	close_display(display);
+}
+
+////////////////////////////////////////////////////////////
+bool input_impl::is_raw_mouse_motion_available()
+{
+	return window_impl_x11::is_raw_motion_available();
+}
+
+////////////////////////////////////////////////////////////
+void input_impl::set_raw_mouse_motion_enabled(bool enabled)
+{
+	window_impl_x11::set_raw_motion_enabled(enabled);
+}
+
+////////////////////////////////////////////////////////////
+bool input_impl::latch_mouse_position(const window& relativeTo, std::array<std::int32_t, 2>& position)
+{
+	window_handle handle = relativeTo.native_handle();
+	if(!handle)
+		return false;
+
+	return window_impl_x11::peek_mouse_position(handle, position);
 }
 
 ////////////////////////////////////////////////////////////
@@ -119,6 +119,24 @@ public:
 	////////////////////////////////////////////////////////////
 	static void set_mouse_position(const std::array<std::int32_t, 2>& position, const window& relativeTo);
 
+	////////////////////////////////////////////////////////////
+	/// \copydoc mouse::is_raw_motion_available
+	///
+	////////////////////////////////////////////////////////////
+	static bool is_raw_mouse_motion_available();
+
+	////////////////////////////////////////////////////////////
+	/// \copydoc mouse::set_raw_motion_enabled
+	///
+	////////////////////////////////////////////////////////////
+	static void set_raw_mouse_motion_enabled(bool enabled);
+
+	////////////////////////////////////////////////////////////
+	/// \copydoc mouse::latch_position
+	///
+	////////////////////////////////////////////////////////////
+	static bool latch_mouse_position(const window& relativeTo, std::array<std::int32_t, 2>& position);
+
 	////////////////////////////////////////////////////////////
 	/// \brief Check if a touch event is currently down
 	///
@@ -8,6 +8,7 @@
 #include <linux/joystick.h>
 #include <mml/system/err.hpp>
 #include <mml/window/joystick_impl.hpp>
+#include <mml/window/unix/event_loop.hpp>
 #include <string>
 #include <unistd.h>
 #include <vector>
@@ -467,6 +468,11 @@ void joystick_impl::initialize()
 				udev_monitor_unref(udevMonitor);
 				udevMonitor = 0;
 			}
+			else
+			{
+				// Wake up waiting threads on hot-plug
+				watch_fd(udev_monitor_get_fd(udevMonitor));
+			}
 		}
 	}
 
@@ -480,6 +486,7 @@ void joystick_impl::cleanup()
 	// Unreference the udev monitor to destroy it
 	if(udevMonitor)
 	{
+		unwatch_fd(udev_monitor_get_fd(udevMonitor));
 		udev_monitor_unref(udevMonitor);
 		udevMonitor = 0;
 	}
@@ -535,6 +542,9 @@ bool joystick_impl::open(unsigned int index)
 		file_ = ::open(devnode.c_str(), O_RDONLY | O_NONBLOCK);
 		if(file_ >= 0)
 		{
+			// Wake up waiting threads on input
+			watch_fd(file_);
+
 			// Retrieve the axes mapping
 			ioctl(file_, JSIOCGAXMAP, mapping_);
 
@@ -564,6 +574,7 @@ bool joystick_impl::open(unsigned int index)
 ////////////////////////////////////////////////////////////
 void joystick_impl::close()
 {
+	unwatch_fd(file_);
 	::close(file_);
 	file_ = -1;
 }
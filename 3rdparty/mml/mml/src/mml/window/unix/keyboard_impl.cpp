@@ -9,6 +9,7 @@
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -30,6 +31,10 @@ KeyCode scancode_to_keycode_mapping[static_cast<std::size_t>(
 	keyboard::scan::ScancodeCount)];						 ///< Mapping of SFML scancode to X11 KeyCode
 keyboard::scancode key_code_to_scancode_mapping[maxKeyCode]; ///< Mapping of X11 KeyCode to SFML scancode
 
+// Pressed key codes, kept up to date by the events while one of our windows has the focus
+std::atomic<std::uint32_t> keyStates[maxKeyCode / 32];
+std::atomic<bool> isKeyMapTracked(false);
+
 ////////////////////////////////////////////////////////////
 bool is_valid_keycode(KeyCode keycode)
 {
@@ -529,9 +534,7 @@ KeyCode key_to_key_code(keyboard::key key)
 
 	if(keysym != NoSymbol)
 	{
-		Display* display = priv::open_display();
-		KeyCode keycode = XKeysymToKeycode(display, keysym);
-		priv::close_display(display);
+		KeyCode keycode = XKeysymToKeycode(priv::get_persistent_display(), keysym);
 
 		if(keycode != nullKeyCode)
 			return keycode;
@@ -547,15 +550,11 @@ KeyCode key_to_key_code(keyboard::key key)
 ////////////////////////////////////////////////////////////
 KeySym scancode_to_key_sym(keyboard::scancode code)
 {
-	Display* display = priv::open_display();
-
 	KeySym keysym = NoSymbol;
 	KeyCode keycode = scancode_to_key_code(code);
 
 	if(keycode != nullKeyCode) // ensure that this Scancode is mapped to keycode
-		keysym = XkbKeycodeToKeysym(display, keycode, 0, 0);
-
-	priv::close_display(display);
+		keysym = XkbKeycodeToKeysym(priv::get_persistent_display(), keycode, 0, 0);
 
 	return keysym;
 }
@@ -565,13 +564,13 @@ bool is_key_pressedImpl(KeyCode keycode)
 {
 	if(keycode != nullKeyCode)
 	{
-		Display* display = priv::open_display();
+		// While we have the focus the events keep the cache exact
+		if(isKeyMapTracked.load(std::memory_order_acquire))
+			return (keyStates[keycode / 32].load(std::memory_order_relaxed) & (1u << (keycode % 32))) != 0;
 
 		// Get the whole keyboard state
 		char keys[32];
-		XQueryKeymap(display, keys);
-
-		priv::close_display(display);
+		XQueryKeymap(priv::get_persistent_display(), keys);
 
 		// Check our keycode
 		return (keys[keycode / 8] & (1 << (keycode % 8))) != 0;
@@ -795,5 +794,39 @@ keyboard::scancode keyboard_impl::get_scancode_from_event(XKeyEvent& event)
 	return key_code_to_scancode(static_cast<KeyCode>(event.keycode));
 }
 
+////////////////////////////////////////////////////////////
+void keyboard_impl::set_key_pressed(unsigned int keycode, bool pressed)
+{
+	if(keycode >= static_cast<unsigned int>(maxKeyCode))
+		return;
+
+	const std::uint32_t bit = 1u << (keycode % 32);
+	if(pressed)
+		keyStates[keycode / 32].fetch_or(bit, std::memory_order_relaxed);
+	else
+		keyStates[keycode / 32].fetch_and(~bit, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////
+void keyboard_impl::set_key_map(const char keys[32])
+{
+	for(std::size_t i = 0; i < maxKeyCode / 32; ++i)
+	{
+		std::uint32_t word = 0;
+		for(std::size_t j = 0; j < 4; ++j)
+			word |= static_cast<std::uint32_t>(static_cast<unsigned char>(keys[i * 4 + j])) << (j * 8);
+
+		keyStates[i].store(word, std::memory_order_relaxed);
+	}
+
+	isKeyMapTracked.store(true, std::memory_order_release);
+}
+
+////////////////////////////////////////////////////////////
+void keyboard_impl::invalidate_key_map()
+{
+	isKeyMapTracked.store(false, std::memory_order_release);
+}
+
 } // namespace priv
 } // namespace mml
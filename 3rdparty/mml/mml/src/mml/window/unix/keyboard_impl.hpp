@@ -67,6 +67,36 @@ public:
 	///
 	////////////////////////////////////////////////////////////
 	static keyboard::scancode get_scancode_from_event(XKeyEvent& event);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Update the cached state of a key from a key event
+	///
+	/// \param keycode X11 key code of the event
+	/// \param pressed True for KeyPress, false for KeyRelease
+	///
+	////////////////////////////////////////////////////////////
+	static void set_key_pressed(unsigned int keycode, bool pressed);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Replace the cached keyboard state
+	///
+	/// Called with the KeymapNotify which follows a FocusIn, or an
+	/// EnterNotify into the focused window. From then on
+	/// is_key_pressed reads the cache.
+	///
+	/// \param keys Bit vector of the pressed key codes
+	///
+	////////////////////////////////////////////////////////////
+	static void set_key_map(const char keys[32]);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Stop trusting the cache when the focus leaves
+	///
+	/// Key events go to another client then, so is_key_pressed
+	/// asks the server again until the next set_key_map.
+	///
+	////////////////////////////////////////////////////////////
+	static void invalidate_key_map();
 };
 
 } // namespace priv
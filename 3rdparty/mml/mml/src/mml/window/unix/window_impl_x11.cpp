@@ -6,15 +6,22 @@
 #include <mml/system/utf.hpp>
 #include <mml/window/unix/clipboard_impl.hpp>
 #include <mml/window/unix/display.hpp>
+#include <mml/window/unix/event_loop.hpp>
 #include <mml/window/unix/input_impl.hpp>
 #include <mml/window/unix/keyboard_impl.hpp>
 #include <mml/window/unix/window_impl_x11.hpp>
 #include <mml/window/window_style.hpp> // important to be included first (conflict with None)
 
 #include <X11/Xatom.h>
+#if defined(MML_HAS_XCB)
+#include <X11/Xlib-xcb.h>
+#endif
 #include <X11/Xlibint.h>
 #include <X11/Xutil.h>
 #include <X11/extensions/Xrandr.h>
+#if defined(MML_HAS_XINPUT2)
+#include <X11/extensions/XInput2.h>
+#endif
 #include <X11/keysym.h>
 
 #include <fcntl.h>
@@ -24,6 +31,8 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -33,6 +42,7 @@
 #include <bitset>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 
 //clang-format on
 
@@ -46,42 +56,29 @@ namespace
 {
 // mml::priv::window_impl_x11*              fullscreenWindow = nullptr;
 std::vector<mml::priv::window_impl_x11*> allWindows;
+std::unordered_map<::Window, mml::priv::window_impl_x11*> windowsByHandle; // Routes events, registered before mapping
 std::bitset<256> isKeyFiltered;
+std::bitset<256> isKeyDown; // A KeyPress of a key already down is an auto-repeat
+::Window focusedWindow = 0;	// Receives the raw motion and the key map, only touched by the thread dispatching events
+::Window keymapOrigin = 0;	// Window of the FocusIn or EnterNotify a KeymapNotify follows
+
+#if defined(MML_HAS_XINPUT2)
+// XInput2 raw motion, see window_impl_x11::set_raw_motion_enabled
+std::once_flag xinput2Flag;
+int xinput2Opcode = 0; // Major opcode of the extension, 0 if not available
+std::atomic<bool> rawMotionEnabled(false);
+std::unordered_map<int, bool> relativeDevices; // Source device -> reports relative x/y
+#endif
 std::mutex allWindowsMutex;
 std::string windowManagerName;
 std::string wmAbsPosGood[] = {"Enlightenment", "FVWM", "i3", "KWin", "Xfwm4"};
 static const unsigned long eventMask = FocusChangeMask | ButtonPressMask | ButtonReleaseMask |
 									   ButtonMotionMask | PointerMotionMask | KeyPressMask | KeyReleaseMask |
 									   StructureNotifyMask | EnterWindowMask | LeaveWindowMask |
-									   VisibilityChangeMask | PropertyChangeMask;
+									   VisibilityChangeMask | PropertyChangeMask | KeymapStateMask;
 
 static const unsigned int maxTrialsCount = 5;
 
-// Predicate we use to find key repeat events in processEvent
-struct KeyRepeatFinder
-{
-	KeyRepeatFinder(unsigned int keycode, Time time)
-		: keycode(keycode)
-		, time(time)
-	{
-	}
-
-	// Predicate operator that checks event type, keycode and timestamp
-	bool operator()(const XEvent& event)
-	{
-		return ((event.type == KeyPress) && (event.xkey.keycode == keycode) && (event.xkey.time - time < 2));
-	}
-
-	unsigned int keycode;
-	Time time;
-};
-// Filter the events received by windows (only allow those matching a specific window)
-Bool checkEvent(::Display*, XEvent* event, XPointer userData)
-{
-	// Just check if the event matches the window
-	return event->xany.window == reinterpret_cast<::Window>(userData);
-}
-
 // Find the name of the current executable
 std::string findExecutableName()
 {
@@ -127,8 +124,8 @@ bool ewmhSupported()
 
 	checked = true;
 
-	Atom netSupportingWmCheck = mml::priv::get_atom("_NET_SUPPORTING_WM_CHECK", true);
-	Atom netSupported = mml::priv::get_atom("_NET_SUPPORTED", true);
+	Atom netSupportingWmCheck = mml::priv::get_atom(mml::priv::atom::net_supporting_wm_check);
+	Atom netSupported = mml::priv::get_atom(mml::priv::atom::net_supported);
 
 	if(!netSupportingWmCheck || !netSupported)
 		return false;
@@ -196,7 +193,7 @@ bool ewmhSupported()
 
 	// We try to get the name of the window manager
 	// for window manager specific workarounds
-	Atom netWmName = mml::priv::get_atom("_NET_WM_NAME", true);
+	Atom netWmName = mml::priv::get_atom(mml::priv::atom::net_wm_name);
 
 	if(!netWmName)
 	{
@@ -204,7 +201,7 @@ bool ewmhSupported()
 		return true;
 	}
 
-	Atom utf8StringType = mml::priv::get_atom("UTF8_STRING");
+	Atom utf8StringType = mml::priv::get_atom(mml::priv::atom::utf8_string);
 
 	if(!utf8StringType)
 		utf8StringType = XA_STRING;
@@ -246,13 +243,142 @@ bool ewmhSupported()
 	return parent;
 }
 
+// Newest MotionNotify of a window seen by latchMotion
+struct LatchedMotion
+{
+	::Window window;
+	bool found;
+	int x;
+	int y;
+};
+
+// Never matches, so XCheckIfEvent walks the whole queue and leaves it untouched
+Bool latchMotion(::Display*, XEvent* event, XPointer userData)
+{
+	LatchedMotion* latch = reinterpret_cast<LatchedMotion*>(userData);
+	if((event->type == MotionNotify) && (event->xmotion.window == latch->window))
+	{
+		latch->found = true;
+		latch->x = event->xmotion.x;
+		latch->y = event->xmotion.y;
+	}
+	return False;
+}
+
+#if defined(MML_HAS_XCB)
+// Root position of a configured window, requested through XCB for all the
+// windows configured in a batch of pending events so that one round trip
+// answers them all. Only touched by the thread dispatching events.
+struct PendingTranslation
+{
+	::Window window;
+	xcb_translate_coordinates_cookie_t cookie;
+	bool received; // The reply was taken, or the error if the window is gone
+	bool valid;
+	int x;
+	int y;
+};
+std::vector<PendingTranslation> pendingTranslations;
+std::vector<::Window> configuredWindows;
+
+// Never matches, collects the windows of real ConfigureNotify events
+Bool collectConfigured(::Display*, XEvent* event, XPointer userData)
+{
+	std::vector<::Window>* windows = reinterpret_cast<std::vector<::Window>*>(userData);
+	if((event->type == ConfigureNotify) && !event->xconfigure.send_event &&
+	   (std::find(windows->begin(), windows->end(), event->xconfigure.window) == windows->end()))
+		windows->push_back(event->xconfigure.window);
+	return False;
+}
+
+// Send the translations for every configured window of ours found in the queue
+void requestTranslations(::Display* display)
+{
+	XEvent event;
+	configuredWindows.clear();
+	XCheckIfEvent(display, &event, &collectConfigured, reinterpret_cast<XPointer>(&configuredWindows));
+
+	if(configuredWindows.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(allWindowsMutex);
+		configuredWindows.erase(std::remove_if(configuredWindows.begin(), configuredWindows.end(),
+											   [](::Window window) { return windowsByHandle.count(window) == 0; }),
+								configuredWindows.end());
+	}
+
+	// Xlib flushes its own requests before XCB sends these
+	xcb_connection_t* connection = XGetXCBConnection(display);
+	const ::Window root = DefaultRootWindow(display);
+	for(::Window window : configuredWindows)
+	{
+		PendingTranslation translation = {window, xcb_translate_coordinates(connection, window, root, 0, 0),
+										  false, false, 0, 0};
+		pendingTranslations.push_back(translation);
+	}
+	xcb_flush(connection);
+}
+
+// Get the root position of the window of a ConfigureNotify from the batch,
+// false if none was requested or the event was generated after the request
+bool takeTranslation(::Display* display, const XConfigureEvent& configure, int& x, int& y)
+{
+	for(PendingTranslation& translation : pendingTranslations)
+	{
+		if(translation.window != configure.window)
+			continue;
+
+		// The event serial is the last request the server processed before sending it
+		if(static_cast<std::int32_t>(static_cast<unsigned int>(configure.serial) - translation.cookie.sequence) >= 0)
+			return false;
+
+		if(!translation.received)
+		{
+			xcb_translate_coordinates_reply_t* reply =
+				xcb_translate_coordinates_reply(XGetXCBConnection(display), translation.cookie, nullptr);
+
+			translation.received = true;
+			translation.valid = reply != nullptr;
+			if(reply)
+			{
+				translation.x = reply->dst_x;
+				translation.y = reply->dst_y;
+				std::free(reply);
+			}
+		}
+
+		if(!translation.valid)
+			return false;
+
+		x = translation.x;
+		y = translation.y;
+		return true;
+	}
+
+	return false;
+}
+
+// Drop the replies no event asked for
+void discardTranslations(::Display* display)
+{
+	xcb_connection_t* connection = XGetXCBConnection(display);
+	for(const PendingTranslation& translation : pendingTranslations)
+	{
+		if(!translation.received)
+			xcb_discard_reply(connection, translation.cookie.sequence);
+	}
+	pendingTranslations.clear();
+}
+#endif
+
 // Get the Frame Extents from EWMH WMs that support it.
 bool getEWMHFrameExtents(::Display* disp, ::Window win, long& xFrameExtent, long& yFrameExtent)
 {
 	if(!ewmhSupported())
 		return false;
 
-	Atom frameExtents = mml::priv::get_atom("_NET_FRAME_EXTENTS", true);
+	Atom frameExtents = mml::priv::get_atom(mml::priv::atom::net_frame_extents);
 
 	if(frameExtents == None)
 		return false;
@@ -522,12 +648,12 @@ namespace priv
 {
 void set_net_wm_state(Display* display, ::Window xwindow, uint32_t style)
 {
-	auto _NET_WM_STATE = get_atom("_NET_WM_STATE", False);
-	//    auto _NET_WM_STATE_FOCUSED = get_atom("_NET_WM_STATE_FOCUSED", False);
-	auto _NET_WM_STATE_ABOVE = get_atom("_NET_WM_STATE_ABOVE", False);
-	//    auto _NET_WM_WINDOW_TYPE = get_atom("_NET_WM_WINDOW_TYPE", False);
-	auto _NET_WM_STATE_SKIP_TASKBAR = get_atom("_NET_WM_STATE_SKIP_TASKBAR", False);
-	auto _NET_WM_STATE_SKIP_PAGER = get_atom("_NET_WM_STATE_SKIP_PAGER", False);
+	auto _NET_WM_STATE = get_atom(atom::net_wm_state);
+	//    auto _NET_WM_STATE_FOCUSED = get_atom(atom::net_wm_state_focused);
+	auto _NET_WM_STATE_ABOVE = get_atom(atom::net_wm_state_above);
+	//    auto _NET_WM_WINDOW_TYPE = get_atom(atom::net_wm_window_type);
+	auto _NET_WM_STATE_SKIP_TASKBAR = get_atom(atom::net_wm_state_skip_taskbar);
+	auto _NET_WM_STATE_SKIP_PAGER = get_atom(atom::net_wm_state_skip_pager);
 
 	Atom atoms[16];
 	int count = 0;
@@ -703,33 +829,33 @@ window_impl_x11::window_impl_x11(video_mode mode, const std::array<std::int32_t,
 
 	long compositor = 2; /* don't disable compositing except for "normal" windows */
 
-	const char* wintype_name = nullptr;
+	atom::id wintype_id = atom::net_wm_window_type_normal;
 	if(style & style::utility)
 	{
-		wintype_name = "_NET_WM_WINDOW_TYPE_UTILITY";
+		wintype_id = atom::net_wm_window_type_utility;
 	}
 	else if(style & style::tooltip)
 	{
-		wintype_name = "_NET_WM_WINDOW_TYPE_TOOLTIP";
+		wintype_id = atom::net_wm_window_type_tooltip;
 	}
 	else if(style & style::popup_menu)
 	{
-		wintype_name = "_NET_WM_WINDOW_TYPE_POPUP_MENU";
+		wintype_id = atom::net_wm_window_type_popup_menu;
 	}
 	else
 	{
-		wintype_name = "_NET_WM_WINDOW_TYPE_NORMAL";
+		wintype_id = atom::net_wm_window_type_normal;
 		compositor = 1; /* disable compositing for "normal" windows */
 	}
 	{
-		auto _NET_WM_WINDOW_TYPE = get_atom("_NET_WM_WINDOW_TYPE", False);
-		auto wintype = get_atom(wintype_name, False);
+		auto _NET_WM_WINDOW_TYPE = get_atom(atom::net_wm_window_type);
+		auto wintype = get_atom(wintype_id);
 		XChangeProperty(display_, window_, _NET_WM_WINDOW_TYPE, XA_ATOM, 32, PropModeReplace,
 						(unsigned char*)&wintype, 1);
 	}
 
 	{
-		auto _NET_WM_BYPASS_COMPOSITOR = get_atom("_NET_WM_BYPASS_COMPOSITOR", False);
+		auto _NET_WM_BYPASS_COMPOSITOR = get_atom(atom::net_wm_bypass_compositor);
 		XChangeProperty(display_, window_, _NET_WM_BYPASS_COMPOSITOR, XA_CARDINAL, 32, PropModeReplace,
 						(unsigned char*)&compositor, 1);
 	}
@@ -740,7 +866,7 @@ window_impl_x11::window_impl_x11(video_mode mode, const std::array<std::int32_t,
 	// change our window's decorations and functions according to the requested style)
 	if(!fullscreen_)
 	{
-		Atom WMHintsAtom = get_atom("_MOTIF_WM_HINTS", false);
+		Atom WMHintsAtom = get_atom(atom::motif_wm_hints);
 		if(WMHintsAtom)
 		{
 			static const unsigned long MWM_HINTS_FUNCTIONS = 1 << 0;
@@ -862,6 +988,14 @@ window_impl_x11::window_impl_x11(video_mode mode, const std::array<std::int32_t,
 ////////////////////////////////////////////////////////////
 window_impl_x11::~window_impl_x11()
 {
+	// Stop routing events to this window
+	{
+		std::lock_guard<std::mutex> lock(allWindowsMutex);
+		std::unordered_map<::Window, window_impl_x11*>::iterator itr = windowsByHandle.find(window_);
+		if((itr != windowsByHandle.end()) && (itr->second == this))
+			windowsByHandle.erase(itr);
+	}
+
 	// Cleanup graphical resources
 	cleanup();
 
@@ -909,72 +1043,285 @@ window_handle window_impl_x11::native_handle() const
 	return window_;
 }
 
+////////////////////////////////////////////////////////////
+bool window_impl_x11::wait_for_events(std::int32_t timeout_ms)
+{
+	::Display* display = open_display();
+
+	// Events already read by Xlib don't make the socket readable again.
+	// Those read by other threads from now on wake the wait up.
+	begin_event_wait();
+	bool ready = XPending(display) > 0;
+	if(!ready)
+		ready = wait_for_fds(ConnectionNumber(display), timeout_ms);
+	end_event_wait();
+
+	close_display(display);
+	return ready;
+}
+
+////////////////////////////////////////////////////////////
+void window_impl_x11::wake_up()
+{
+	wake_up_wait();
+}
+
 ////////////////////////////////////////////////////////////
 void window_impl_x11::process_events()
+{
+	// Every window shares the display, so one pass serves them all and
+	// later calls in the same pump find the queue empty
+	dispatch_events(display_);
+}
+
+////////////////////////////////////////////////////////////
+void window_impl_x11::dispatch_events(::Display* display)
 {
 	XEvent event;
 
-	// Pick out the events that are interesting for this window
-	while(XCheckIfEvent(display_, &event, &checkEvent, reinterpret_cast<XPointer>(window_)))
-	{
-		// This function implements a workaround to properly discard
-		// repeated key events when necessary. The problem is that the
-		// system's key events policy doesn't match mml's one: X server will generate
-		// both repeated KeyPress and KeyRelease events when maintaining a key down, while
-		// mml only wants repeated KeyPress events. Thus, we have to:
-		// - Discard duplicated KeyRelease events when m_keyRepeat is true
-		// - Discard both duplicated KeyPress and KeyRelease events when m_keyRepeat is false
+	// Only servers without XKB detectable auto-repeat send fake KeyRelease events
+	const bool fakeKeyReleases = !priv::has_detectable_auto_repeat();
 
-		bool processThisEvent = true;
+#if defined(MML_HAS_XCB)
+	// Configured windows cost a round trip each through Xlib, through XCB the
+	// whole batch costs one
+	requestTranslations(display);
+#endif
 
-		// Detect repeated key events
-		while(event.type == KeyRelease)
+	// Read each pending event once and route it to its window
+	while(XPending(display))
+	{
+		XNextEvent(display, &event);
+
+#if defined(MML_HAS_XINPUT2)
+		if((event.type == GenericEvent) && xinput2Opcode && (event.xcookie.extension == xinput2Opcode))
 		{
-			XEvent nextEvent;
-			if(XCheckIfEvent(display_, &nextEvent, checkEvent, reinterpret_cast<XPointer>(window_)))
+			if(XGetEventData(display, &event.xcookie))
 			{
-				if((nextEvent.type == KeyPress) && (nextEvent.xkey.keycode == event.xkey.keycode) &&
-				   (event.xkey.time <= nextEvent.xkey.time) && (nextEvent.xkey.time <= event.xkey.time + 1))
-				{
-					// This sequence of events comes from maintaining a key down
-					if(key_repeat_)
-					{
-						// Ignore the KeyRelease event and process the KeyPress event
-						event = nextEvent;
-						break;
-					}
-					else
-					{
-						// Ignore both events
-						processThisEvent = false;
-						break;
-					}
-				}
-				else
-				{
-					// This sequence of events does not come from maintaining a key down,
-					// so process the KeyRelease event normally,
-					process_event(event);
-					// but loop because the next event can be the first half
-					// of a sequence coming from maintaining a key down.
-					event = nextEvent;
-				}
-			}
-			else
-			{
-				// No event after this KeyRelease event so assume it can be processed.
-				break;
+				dispatch_xinput2_event(display, event.xcookie);
+				XFreeEventData(display, &event.xcookie);
 			}
+			continue;
+		}
+#endif
+
+		// Sent right after every FocusIn and EnterNotify, with the keys held
+		// at that time. Only a focused window keeps getting the key events
+		// which keep the map current, otherwise queries ask the server.
+		if(event.type == KeymapNotify)
+		{
+			if((keymapOrigin != 0) && (keymapOrigin == focusedWindow))
+				keyboard_impl::set_key_map(event.xkeymap.key_vector);
+			keymapOrigin = 0;
+			continue;
 		}
 
-		if(processThisEvent)
+		// Xlib leaves the KeymapNotify's window unset, remember whose it is
+		keymapOrigin = ((event.type == FocusIn) || (event.type == EnterNotify)) ? event.xany.window : 0;
+
+		window_impl_x11* window = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(allWindowsMutex);
+			std::unordered_map<::Window, window_impl_x11*>::const_iterator itr =
+				windowsByHandle.find(event.xany.window);
+			if(itr != windowsByHandle.end())
+				window = itr->second;
+		}
+
+		if(!window)
+		{
+			// The hidden clipboard window, anything else is dropped
+			priv::clipboard_impl::dispatch_event(event);
+			continue;
+		}
+
+		// Handling a real ConfigureNotify costs a round trip, only the
+		// newest of a burst (e.g. while the window is dragged) matters
+		if((event.type == ConfigureNotify) && XEventsQueued(display, QueuedAlready))
+		{
+			XEvent nextEvent;
+			XPeekEvent(display, &nextEvent);
+
+			if((nextEvent.type == ConfigureNotify) && (nextEvent.xconfigure.window == event.xconfigure.window))
+				continue;
+		}
+
+		// Fallback for servers without detectable auto-repeat: a held key
+		// generates KeyRelease/KeyPress pairs with the same timestamp. Drop
+		// the KeyRelease, the KeyPress is then seen as a repeat.
+		if(fakeKeyReleases && (event.type == KeyRelease) && XEventsQueued(display, QueuedAfterReading))
+		{
+			XEvent nextEvent;
+			XPeekEvent(display, &nextEvent);
+
+			if((nextEvent.type == KeyPress) && (nextEvent.xkey.window == event.xkey.window) &&
+			   (nextEvent.xkey.keycode == event.xkey.keycode) && (event.xkey.time <= nextEvent.xkey.time) &&
+			   (nextEvent.xkey.time <= event.xkey.time + 1))
+				continue;
+		}
+
+		window->process_event(event);
+	}
+
+#if defined(MML_HAS_XCB)
+	discardTranslations(display);
+#endif
+}
+
+#if defined(MML_HAS_XINPUT2)
+
+////////////////////////////////////////////////////////////
+void window_impl_x11::dispatch_xinput2_event(::Display* display, XGenericEventCookie& cookie)
+{
+	// Device ids are reused after a hot plug
+	if(cookie.evtype == XI_HierarchyChanged)
+	{
+		relativeDevices.clear();
+		return;
+	}
+
+	// Events still queued when raw motion was disabled are dropped
+	if((cookie.evtype != XI_RawMotion) || !rawMotionEnabled.load(std::memory_order_relaxed))
+		return;
+
+	const XIRawEvent& raw = *static_cast<XIRawEvent*>(cookie.data);
+
+	// Tablets and touch screens report absolute raw values, which are no deltas
+	std::unordered_map<int, bool>::iterator device = relativeDevices.find(raw.sourceid);
+	if(device == relativeDevices.end())
+	{
+		bool relative = false;
+		int count = 0;
+		if(XIDeviceInfo* info = XIQueryDevice(display, raw.sourceid, &count))
 		{
-			process_event(event);
+			for(int i = 0; i < info->num_classes; ++i)
+			{
+				const XIAnyClassInfo* classInfo = info->classes[i];
+				if(classInfo->type != XIValuatorClass)
+					continue;
+
+				const XIValuatorClassInfo* valuator = reinterpret_cast<const XIValuatorClassInfo*>(classInfo);
+				if(valuator->number == 0)
+					relative = (valuator->mode == XIModeRelative);
+			}
+			XIFreeDeviceInfo(info);
 		}
+		device = relativeDevices.insert(std::make_pair(raw.sourceid, relative)).first;
+	}
+
+	if(!device->second)
+		return;
+
+	// raw_values only holds the valuators set in the mask, in order
+	float delta[2] = {0.f, 0.f};
+	const double* value = raw.raw_values;
+	for(int axis = 0; (axis < 2) && (axis < raw.valuators.mask_len * 8); ++axis)
+	{
+		if(XIMaskIsSet(raw.valuators.mask, axis))
+			delta[axis] = static_cast<float>(*value++);
 	}
 
-	// Process clipboard window events
-	priv::clipboard_impl::process_events();
+	if((delta[0] == 0.f) && (delta[1] == 0.f))
+		return;
+
+	window_impl_x11* window = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(allWindowsMutex);
+		std::unordered_map<::Window, window_impl_x11*>::const_iterator itr = windowsByHandle.find(focusedWindow);
+		if(itr != windowsByHandle.end())
+			window = itr->second;
+	}
+
+	if(!window)
+		return;
+
+	platform_event event;
+	event.type = platform_event::mouse_moved_raw;
+	event.time = static_cast<std::uint32_t>(raw.time);
+	event.mouse_move_raw.delta_x = delta[0];
+	event.mouse_move_raw.delta_y = delta[1];
+	window->push_event(event);
+}
+
+////////////////////////////////////////////////////////////
+bool window_impl_x11::is_raw_motion_available()
+{
+	std::call_once(xinput2Flag,
+				   []
+				   {
+					   ::Display* display = get_persistent_display();
+
+					   int opcode = 0, firstEvent = 0, firstError = 0;
+					   if(!XQueryExtension(display, "XInputExtension", &opcode, &firstEvent, &firstError))
+						   return;
+
+					   // Raw events came with XInput 2.0, but announcing 2.1 makes
+					   // the server keep sending them while another client
+					   // grabs the pointer. A 2.0 server still answers Success.
+					   int major = 2, minor = 1;
+					   if(XIQueryVersion(display, &major, &minor) == Success)
+						   xinput2Opcode = opcode;
+				   });
+
+	return xinput2Opcode != 0;
+}
+
+////////////////////////////////////////////////////////////
+void window_impl_x11::set_raw_motion_enabled(bool enabled)
+{
+	if(!is_raw_motion_available())
+		return;
+
+	::Display* display = get_persistent_display();
+
+	unsigned char mask[XIMaskLen(XI_RawMotion)] = {};
+	if(enabled)
+	{
+		XISetMask(mask, XI_RawMotion);
+		XISetMask(mask, XI_HierarchyChanged);
+	}
+
+	XIEventMask xinput2Mask;
+	xinput2Mask.deviceid = XIAllMasterDevices;
+	xinput2Mask.mask_len = sizeof(mask);
+	xinput2Mask.mask = mask;
+	XISelectEvents(display, DefaultRootWindow(display), &xinput2Mask, 1);
+	XFlush(display);
+
+	rawMotionEnabled = enabled;
+}
+
+#else
+
+////////////////////////////////////////////////////////////
+bool window_impl_x11::is_raw_motion_available()
+{
+	// Built without libXi
+	return false;
+}
+
+////////////////////////////////////////////////////////////
+void window_impl_x11::set_raw_motion_enabled(bool /*enabled*/)
+{
+}
+
+#endif
+
+////////////////////////////////////////////////////////////
+bool window_impl_x11::peek_mouse_position(::Window handle, std::array<std::int32_t, 2>& position)
+{
+	::Display* display = get_persistent_display();
+
+	// Also reads what already arrived on the connection, without blocking
+	LatchedMotion latch = {handle, false, 0, 0};
+	XEvent event;
+	XCheckIfEvent(display, &event, &latchMotion, reinterpret_cast<XPointer>(&latch));
+
+	if(!latch.found)
+		return false;
+
+	position = {{latch.x, latch.y}};
+	return true;
 }
 
 ////////////////////////////////////////////////////////////
@@ -1053,10 +1400,12 @@ void window_impl_x11::set_position(const std::array<std::int32_t, 2>& position)
 ////////////////////////////////////////////////////////////
 std::array<std::uint32_t, 2> window_impl_x11::get_size() const
 {
-	XWindowAttributes attributes;
-	XGetWindowAttributes(display_, window_, &attributes);
-	return std::array<std::uint32_t, 2>{
-		{static_cast<std::uint32_t>(attributes.width), static_cast<std::uint32_t>(attributes.height)}};
+	// XGetWindowAttributes costs two round trips, the geometry alone one
+	::Window root;
+	int x, y;
+	unsigned int width = 0, height = 0, borderWidth, depth;
+	XGetGeometry(display_, window_, &root, &x, &y, &width, &height, &borderWidth, &depth);
+	return std::array<std::uint32_t, 2>{{width, height}};
 }
 
 ////////////////////////////////////////////////////////////
@@ -1092,15 +1441,15 @@ void window_impl_x11::set_title(const std::string& title)
 	std::basic_string<std::uint8_t> utf8Title;
 	utf32::to_utf8(title.begin(), title.end(), std::back_inserter(utf8Title));
 
-	Atom useUtf8 = get_atom("UTF8_STRING", false);
+	Atom useUtf8 = get_atom(atom::utf8_string);
 
 	// Set the _NET_WM_NAME atom, which specifies a UTF-8 encoded window title.
-	Atom wmName = get_atom("_NET_WM_NAME", false);
+	Atom wmName = get_atom(atom::net_wm_name);
 	XChangeProperty(display_, window_, wmName, useUtf8, 8, PropModeReplace, utf8Title.c_str(),
 					utf8Title.size());
 
 	// Set the _NET_WM_ICON_NAME atom, which specifies a UTF-8 encoded window title.
-	Atom wmIconName = get_atom("_NET_WM_ICON_NAME", false);
+	Atom wmIconName = get_atom(atom::net_wm_icon_name);
 	XChangeProperty(display_, window_, wmIconName, useUtf8, 8, PropModeReplace, utf8Title.c_str(),
 					utf8Title.size());
 
@@ -1194,7 +1543,7 @@ void window_impl_x11::set_icon(unsigned int width, unsigned int height, const st
 				 (pixels[i * 4 + 3] << 24);
 	}
 
-	Atom netWmIcon = get_atom("_NET_WM_ICON");
+	Atom netWmIcon = get_atom(atom::net_wm_icon);
 
 	XChangeProperty(display_, window_, netWmIcon, XA_CARDINAL, 32, PropModeReplace,
 					reinterpret_cast<const unsigned char*>(&icccmIconPixels[0]), 2 + width * height);
@@ -1233,11 +1582,11 @@ void window_impl_x11::set_visible(bool visible)
 void window_impl_x11::maximize()
 {
 
-	Atom _NET_WM_STATE = get_atom("_NET_WM_STATE", false);
+	Atom _NET_WM_STATE = get_atom(atom::net_wm_state);
 
-	Atom _NET_WM_STATE_MAXIMIZED_VERT = get_atom("_NET_WM_STATE_MAXIMIZED_VERT", false);
+	Atom _NET_WM_STATE_MAXIMIZED_VERT = get_atom(atom::net_wm_state_maximized_vert);
 
-	Atom _NET_WM_STATE_MAXIMIZED_HORZ = get_atom("_NET_WM_STATE_MAXIMIZED_HORZ", false);
+	Atom _NET_WM_STATE_MAXIMIZED_HORZ = get_atom(atom::net_wm_state_maximized_horz);
 
 	if(window_mapped_)
 	{
@@ -1280,11 +1629,11 @@ static Bool is_map_notify(Display* /*dpy*/, XEvent* ev, XPointer win)
 void window_impl_x11::restore()
 {
 	{
-		Atom _NET_WM_STATE = get_atom("_NET_WM_STATE", false);
+		Atom _NET_WM_STATE = get_atom(atom::net_wm_state);
 
-		Atom _NET_WM_STATE_MAXIMIZED_VERT = get_atom("_NET_WM_STATE_MAXIMIZED_VERT", false);
+		Atom _NET_WM_STATE_MAXIMIZED_VERT = get_atom(atom::net_wm_state_maximized_vert);
 
-		Atom _NET_WM_STATE_MAXIMIZED_HORZ = get_atom("_NET_WM_STATE_MAXIMIZED_HORZ", false);
+		Atom _NET_WM_STATE_MAXIMIZED_HORZ = get_atom(atom::net_wm_state_maximized_horz);
 
 		if(window_mapped_)
 		{
@@ -1328,7 +1677,7 @@ void window_impl_x11::restore()
 	}
 
 	{
-		Atom _NET_ACTIVE_WINDOW = get_atom("_NET_ACTIVE_WINDOW", false);
+		Atom _NET_ACTIVE_WINDOW = get_atom(atom::net_active_window);
 
 		if(window_mapped_)
 		{
@@ -1357,7 +1706,7 @@ void window_impl_x11::set_opacity(float opacity)
 	const std::uint32_t fully_opaque = 0xFFFFFFFF;
 	const long alpha = (long)((double)opacity * (double)fully_opaque);
 
-	Atom property = get_atom("_NET_WM_WINDOW_OPACITY", false);
+	Atom property = get_atom(atom::net_wm_window_opacity);
 	if(property != None)
 	{
 		XChangeProperty(display_, window_, property, XA_CARDINAL, 32, PropModeReplace, (unsigned char*)&alpha,
@@ -1493,7 +1842,7 @@ void window_impl_x11::grab_focus()
 	Atom netActiveWindow = None;
 
 	if(ewmhSupported())
-		netActiveWindow = get_atom("_NET_ACTIVE_WINDOW");
+		netActiveWindow = get_atom(atom::net_active_window);
 
 	// Only try to grab focus if the window is mapped
 	XWindowAttributes attr;
@@ -1535,8 +1884,8 @@ void window_impl_x11::grab_focus()
 ////////////////////////////////////////////////////////////
 void window_impl_x11::set_protocols()
 {
-	Atom wmProtocols = get_atom("WM_PROTOCOLS");
-	Atom wmDeleteWindow = get_atom("WM_DELETE_WINDOW");
+	Atom wmProtocols = get_atom(atom::wm_protocols);
+	Atom wmDeleteWindow = get_atom(atom::wm_delete_window);
 
 	if(!wmProtocols)
 	{
@@ -1560,8 +1909,8 @@ void window_impl_x11::set_protocols()
 
 	if(ewmhSupported())
 	{
-		netWmPing = get_atom("_NET_WM_PING", true);
-		netWmPid = get_atom("_NET_WM_PID", true);
+		netWmPing = get_atom(atom::net_wm_ping);
+		netWmPid = get_atom(atom::net_wm_pid);
 	}
 
 	if(netWmPing && netWmPid)
@@ -1588,6 +1937,12 @@ void window_impl_x11::set_protocols()
 ////////////////////////////////////////////////////////////
 void window_impl_x11::initialize(bool visible)
 {
+	// Route events before mapping, set_visible waits for MapNotify
+	{
+		std::lock_guard<std::mutex> lock(allWindowsMutex);
+		windowsByHandle[window_] = this;
+	}
+
 	// Create the input context
 	input_method_ = XOpenIM(display_, nullptr, nullptr, nullptr);
 
@@ -1606,8 +1961,8 @@ void window_impl_x11::initialize(bool visible)
 				 "unicode"
 			  << std::endl;
 
-	Atom wmWindowType = get_atom("_NET_WM_WINDOW_TYPE", false);
-	Atom wmWindowTypeNormal = get_atom("_NET_WM_WINDOW_TYPE_NORMAL", false);
+	Atom wmWindowType = get_atom(atom::net_wm_window_type);
+	Atom wmWindowTypeNormal = get_atom(atom::net_wm_window_type_normal);
 
 	if(wmWindowType && wmWindowTypeNormal)
 	{
@@ -1637,7 +1992,7 @@ void window_impl_x11::update_last_input_time(::Time time)
 {
 	if(time && (time != last_input_time_))
 	{
-		Atom netWmUserTime = get_atom("_NET_WM_USER_TIME", true);
+		Atom netWmUserTime = get_atom(atom::net_wm_user_time);
 
 		if(netWmUserTime)
 		{
@@ -1699,6 +2054,8 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			if(input_context_)
 				XSetICFocus(input_context_);
 
+			focusedWindow = window_;
+
 			// Grab cursor
 			if(cursor_grabbed_)
 			{
@@ -1747,10 +2104,17 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			if(input_context_)
 				XUnsetICFocus(input_context_);
 
+			if(focusedWindow == window_)
+				focusedWindow = 0;
+
 			// Release cursor
 			if(cursor_grabbed_)
 				XUngrabPointer(display_, CurrentTime);
 
+			// The releases of held keys go to the next focused window
+			isKeyDown.reset();
+			keyboard_impl::invalidate_key_map();
+
 			platform_event event;
 			event.type = platform_event::lost_focus;
 			push_event(event);
@@ -1763,15 +2127,21 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			/* Real configure notify events are relative to the parent, synthetic events are absolute. */
 			if(!windowEvent.xconfigure.send_event)
 			{
-				unsigned int NumChildren;
-				Window ChildReturn, Root, Parent;
-				Window* Children;
-				/* Translate these coodinates back to relative to root */
-				XQueryTree(display_, windowEvent.xconfigure.window, &Root, &Parent, &Children, &NumChildren);
-				XTranslateCoordinates(windowEvent.xconfigure.display, Parent,
-									  DefaultRootWindow(windowEvent.xconfigure.display),
-									  windowEvent.xconfigure.x, windowEvent.xconfigure.y,
-									  &windowEvent.xconfigure.x, &windowEvent.xconfigure.y, &ChildReturn);
+				/* Translate our own origin to the root in one round trip, instead of
+				   looking up the parent first. The event's position includes the border. */
+				bool translated = false;
+#if defined(MML_HAS_XCB)
+				translated = takeTranslation(display_, windowEvent.xconfigure, windowEvent.xconfigure.x,
+											 windowEvent.xconfigure.y);
+#endif
+				if(!translated)
+				{
+					::Window child;
+					XTranslateCoordinates(display_, window_, DefaultRootWindow(display_), 0, 0,
+										  &windowEvent.xconfigure.x, &windowEvent.xconfigure.y, &child);
+				}
+				windowEvent.xconfigure.x -= windowEvent.xconfigure.border_width;
+				windowEvent.xconfigure.y -= windowEvent.xconfigure.border_width;
 			}
 			if((windowEvent.xconfigure.x != previous_pos_[0]) ||
 			   (windowEvent.xconfigure.y != previous_pos_[1]))
@@ -1807,13 +2177,13 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			// Input methods might want random ClientMessage events
 			if(!XFilterEvent(&windowEvent, None))
 			{
-				static Atom wmProtocols = get_atom("WM_PROTOCOLS");
+				static Atom wmProtocols = get_atom(atom::wm_protocols);
 
 				// Handle window manager protocol messages we support
 				if(windowEvent.xclient.message_type == wmProtocols)
 				{
-					static Atom wmDeleteWindow = get_atom("WM_DELETE_WINDOW");
-					static Atom netWmPing = ewmhSupported() ? get_atom("_NET_WM_PING", true) : None;
+					static Atom wmDeleteWindow = get_atom(atom::wm_delete_window);
+					static Atom netWmPing = ewmhSupported() ? get_atom(atom::net_wm_ping) : None;
 
 					if((windowEvent.xclient.format == 32) &&
 					   (windowEvent.xclient.data.l[0]) == static_cast<long>(wmDeleteWindow))
@@ -1841,16 +2211,29 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			// Key down event
 		case KeyPress:
 		{
+			// With detectable auto-repeat, holding a key only sends KeyPress events
+			const bool repeat = (windowEvent.xkey.keycode != 0) && isKeyDown.test(windowEvent.xkey.keycode);
+			if(repeat && !key_repeat_)
+				break;
+
+			if(windowEvent.xkey.keycode != 0)
+			{
+				isKeyDown.set(windowEvent.xkey.keycode);
+				keyboard_impl::set_key_pressed(windowEvent.xkey.keycode, true);
+			}
+
 			// Fill the event parameters
 			// TODO: if modifiers are wrong, use XGetModifierMapping to retrieve the actual modifiers mapping
 			platform_event event;
 			event.type = platform_event::key_pressed;
+			event.time = windowEvent.xkey.time;
 			event.key.code = keyboard_impl::get_key_from_event(windowEvent.xkey);
 			event.key.scancode = keyboard_impl::get_scancode_from_event(windowEvent.xkey);
 			event.key.alt = windowEvent.xkey.state & Mod1Mask;
 			event.key.control = windowEvent.xkey.state & ControlMask;
 			event.key.shift = windowEvent.xkey.state & ShiftMask;
 			event.key.system = windowEvent.xkey.state & Mod4Mask;
+			event.key.repeat = repeat;
 
 			const bool filtered = XFilterEvent(&windowEvent, None);
 
@@ -1904,6 +2287,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 							{
 								platform_event textEvent;
 								textEvent.type = platform_event::text_entered;
+								textEvent.time = windowEvent.xkey.time;
 								textEvent.text.unicode = unicode;
 								push_event(textEvent);
 							}
@@ -1919,6 +2303,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 					{
 						platform_event textEvent;
 						textEvent.type = platform_event::text_entered;
+						textEvent.time = windowEvent.xkey.time;
 						textEvent.text.unicode = static_cast<std::uint32_t>(keyBuffer[0]);
 						push_event(textEvent);
 					}
@@ -1933,15 +2318,20 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			// Key up event
 		case KeyRelease:
 		{
+			isKeyDown.reset(windowEvent.xkey.keycode);
+			keyboard_impl::set_key_pressed(windowEvent.xkey.keycode, false);
+
 			// Fill the event parameters
 			platform_event event;
 			event.type = platform_event::key_released;
+			event.time = windowEvent.xkey.time;
 			event.key.code = keyboard_impl::get_key_from_event(windowEvent.xkey);
 			event.key.scancode = keyboard_impl::get_scancode_from_event(windowEvent.xkey);
 			event.key.alt = windowEvent.xkey.state & Mod1Mask;
 			event.key.control = windowEvent.xkey.state & ControlMask;
 			event.key.shift = windowEvent.xkey.state & ShiftMask;
 			event.key.system = windowEvent.xkey.state & Mod4Mask;
+			event.key.repeat = false;
 			push_event(event);
 
 			break;
@@ -1957,6 +2347,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			{
 				platform_event event;
 				event.type = platform_event::mouse_button_pressed;
+				event.time = windowEvent.xbutton.time;
 				event.mouse_button.x = windowEvent.xbutton.x;
 				event.mouse_button.y = windowEvent.xbutton.y;
 
@@ -1988,6 +2379,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			{
 				platform_event event;
 				event.type = platform_event::mouse_button_released;
+				event.time = windowEvent.xbutton.time;
 				event.mouse_button.x = windowEvent.xbutton.x;
 				event.mouse_button.y = windowEvent.xbutton.y;
 				switch(button)
@@ -2015,6 +2407,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 				platform_event event;
 
 				event.type = platform_event::mouse_wheel_scrolled;
+				event.time = windowEvent.xbutton.time;
 				event.mouse_wheel_scroll.wheel = mouse::vertical_wheel;
 				event.mouse_wheel_scroll.delta = (button == Button4) ? 1 : -1;
 				event.mouse_wheel_scroll.x = windowEvent.xbutton.x;
@@ -2025,6 +2418,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			{
 				platform_event event;
 				event.type = platform_event::mouse_wheel_scrolled;
+				event.time = windowEvent.xbutton.time;
 				event.mouse_wheel_scroll.wheel = mouse::horizontal_wheel;
 				event.mouse_wheel_scroll.delta = (button == 6) ? 1 : -1;
 				event.mouse_wheel_scroll.x = windowEvent.xbutton.x;
@@ -2039,6 +2433,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 		{
 			platform_event event;
 			event.type = platform_event::mouse_moved;
+			event.time = windowEvent.xmotion.time;
 			event.mouse_move.x = windowEvent.xmotion.x;
 			event.mouse_move.y = windowEvent.xmotion.y;
 			push_event(event);
@@ -2052,6 +2447,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			{
 				platform_event event;
 				event.type = platform_event::mouse_entered;
+				event.time = windowEvent.xcrossing.time;
 				push_event(event);
 			}
 			break;
@@ -2064,6 +2460,7 @@ bool window_impl_x11::process_event(XEvent& windowEvent)
 			{
 				platform_event event;
 				event.type = platform_event::mouse_left;
+				event.time = windowEvent.xcrossing.time;
 				push_event(event);
 			}
 			break;
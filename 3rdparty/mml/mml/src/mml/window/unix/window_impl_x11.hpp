@@ -169,6 +169,56 @@ public:
 	////////////////////////////////////////////////////////////
 	virtual bool has_focus() const;
 
+	////////////////////////////////////////////////////////////
+	/// \brief Block until the X connection or the wake up pipe
+	///        becomes readable
+	///
+	/// \param timeout_ms Timeout in milliseconds, negative to wait forever
+	///
+	/// \return True if events or a wake up arrived before the timeout
+	///
+	////////////////////////////////////////////////////////////
+	static bool wait_for_events(std::int32_t timeout_ms);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Interrupt a thread blocked in wait_for_events
+	///
+	////////////////////////////////////////////////////////////
+	static void wake_up();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Tell whether the server has XInput2 raw motion
+	///
+	/// \return True if set_raw_motion_enabled can be used
+	///
+	////////////////////////////////////////////////////////////
+	static bool is_raw_motion_available();
+
+	////////////////////////////////////////////////////////////
+	/// \brief Select or deselect XInput2 raw motion on the root
+	///        window of the shared display
+	///
+	/// \param enabled True to send mouse_moved_raw events to the
+	///                focused window
+	///
+	////////////////////////////////////////////////////////////
+	static void set_raw_motion_enabled(bool enabled);
+
+	////////////////////////////////////////////////////////////
+	/// \brief Get the position of the newest motion event of a
+	///        window still waiting to be processed
+	///
+	/// No round trip: only the events which already reached the
+	/// connection are looked at, and all of them stay queued.
+	///
+	/// \param handle   Window the motion must belong to
+	/// \param position Receives the position, relative to the window
+	///
+	/// \return True if a motion event of the window was pending
+	///
+	////////////////////////////////////////////////////////////
+	static bool peek_mouse_position(::Window handle, std::array<std::int32_t, 2>& position);
+
 protected:
 	////////////////////////////////////////////////////////////
 	/// \brief Process incoming events from the operating system
@@ -177,6 +227,26 @@ protected:
 	virtual void process_events();
 
 private:
+	////////////////////////////////////////////////////////////
+	/// \brief Read all pending events of the display once and
+	///        route each of them to the window it belongs to
+	///
+	/// \param display Display shared by all the windows
+	///
+	////////////////////////////////////////////////////////////
+	static void dispatch_events(::Display* display);
+
+#if defined(MML_HAS_XINPUT2)
+	////////////////////////////////////////////////////////////
+	/// \brief Handle an XInput2 event, which has no window
+	///
+	/// \param display Display shared by all the windows
+	/// \param cookie  Cookie of the event, with its data fetched
+	///
+	////////////////////////////////////////////////////////////
+	static void dispatch_xinput2_event(::Display* display, XGenericEventCookie& cookie);
+#endif
+
 	////////////////////////////////////////////////////////////
 	/// \brief Request the WM to make the current window active
 	///
@@ -672,6 +672,38 @@ void input_impl::set_mouse_position(const std::array<std::int32_t, 2>& position,
 }
 
 
+////////////////////////////////////////////////////////////
+bool input_impl::is_raw_mouse_motion_available()
+{
+    // Not implemented yet (WM_INPUT)
+    return false;
+}
+
+
+////////////////////////////////////////////////////////////
+void input_impl::set_raw_mouse_motion_enabled(bool /*enabled*/)
+{
+    // Not implemented yet (WM_INPUT)
+}
+
+
+////////////////////////////////////////////////////////////
+bool input_impl::latch_mouse_position(const window& relativeTo, std::array<std::int32_t, 2>& position)
+{
+    window_handle handle = relativeTo.native_handle();
+    if (!handle)
+        return false;
+
+    // Windows merges mouse moves, at most one WM_MOUSEMOVE is queued and it is the newest
+    MSG message;
+    if (!PeekMessageW(&message, handle, WM_MOUSEMOVE, WM_MOUSEMOVE, PM_NOREMOVE | PM_NOYIELD))
+        return false;
+
+    position = {{static_cast<std::int16_t>(LOWORD(message.lParam)), static_cast<std::int16_t>(HIWORD(message.lParam))}};
+    return true;
+}
+
+
 ////////////////////////////////////////////////////////////
 bool input_impl::is_touch_down(unsigned int /*finger*/)
 {
@@ -39,6 +39,13 @@ namespace
     const wchar_t*             class_name        = L"MML_Window";
     mml::priv::window_impl_win32* fullscreenWindow = nullptr;
 
+    // Auto-reset event used to interrupt wait_for_events from other threads
+    HANDLE get_wake_up_event()
+    {
+        static const HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        return event;
+    }
+
     void set_process_dpi_aware()
     {
         // Try SetProcessDpiAwareness first
@@ -302,6 +309,30 @@ void window_impl_win32::process_events()
 }
 
 
+////////////////////////////////////////////////////////////
+bool window_impl_win32::wait_for_events(std::int32_t timeout_ms)
+{
+    HANDLE wakeUpEvent = get_wake_up_event();
+    const DWORD timeout = timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms);
+
+    // MWMO_INPUTAVAILABLE also returns for messages that were already seen
+    // but not removed by a previous PeekMessage
+    const DWORD result = MsgWaitForMultipleObjectsEx(wakeUpEvent ? 1 : 0, &wakeUpEvent, timeout,
+                                                     QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+    return (result != WAIT_TIMEOUT) && (result != WAIT_FAILED);
+}
+
+
+////////////////////////////////////////////////////////////
+void window_impl_win32::wake_up()
+{
+    HANDLE wakeUpEvent = get_wake_up_event();
+    if (wakeUpEvent)
+        SetEvent(wakeUpEvent);
+}
+
+
 ////////////////////////////////////////////////////////////
 std::array<std::int32_t, 2> window_impl_win32::get_position() const
 {
@@ -779,6 +810,7 @@ void window_impl_win32::process_event(UINT message, WPARAM wParam, LPARAM lParam
                 event.key.system   = HIWORD(GetKeyState(VK_LWIN)) || HIWORD(GetKeyState(VK_RWIN));
                 event.key.code     = virtual_key_code_to_mml(wParam, lParam);
                 event.key.scancode = to_scancode(wParam, lParam);
+                event.key.repeat   = (HIWORD(lParam) & KF_REPEAT) != 0;
                 push_event(event);
             }
             break;
@@ -796,6 +828,7 @@ void window_impl_win32::process_event(UINT message, WPARAM wParam, LPARAM lParam
             event.key.system   = HIWORD(GetKeyState(VK_LWIN)) || HIWORD(GetKeyState(VK_RWIN));
             event.key.code     = virtual_key_code_to_mml(wParam, lParam);
             event.key.scancode = to_scancode(wParam, lParam);
+            event.key.repeat   = false;
             push_event(event);
             break;
         }
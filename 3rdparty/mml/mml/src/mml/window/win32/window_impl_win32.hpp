@@ -165,6 +165,23 @@ public:
     ////////////////////////////////////////////////////////////
     bool has_focus() const final;
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Block until the thread has messages in its queue
+    ///        or wake_up is called
+    ///
+    /// \param timeout_ms Timeout in milliseconds, negative to wait forever
+    ///
+    /// \return True if messages or a wake up arrived before the timeout
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool wait_for_events(std::int32_t timeout_ms);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Interrupt a thread blocked in wait_for_events
+    ///
+    ////////////////////////////////////////////////////////////
+    static void wake_up();
+
 protected:
 
     ////////////////////////////////////////////////////////////
@@ -4,7 +4,6 @@
 #include <mml/window/window.hpp>
 #include <mml/window/window_impl.hpp>
 #include <mml/system/err.hpp>
-#include <cstring>
 
 namespace
 {
@@ -18,7 +17,9 @@ namespace mml
 window::window() :
 impl_          (nullptr),
 size_          ({{0, 0}}),
-visible_(false)
+visible_(false),
+callback_(nullptr),
+callback_user_data_(nullptr)
 {
 
 }
@@ -30,6 +31,8 @@ window::window(video_mode mode, const std::array<std::int32_t, 2>& position,
     : impl_(nullptr)
     , size_({{0, 0}})
     , visible_(true)
+    , callback_(nullptr)
+    , callback_user_data_(nullptr)
 {
     create(mode, position, title, style);
 }
@@ -40,6 +43,8 @@ window::window(window_handle handle)
     : impl_          (nullptr)
     , size_          ({{0, 0}})
     , visible_(true)
+    , callback_(nullptr)
+    , callback_user_data_(nullptr)
 {
     create(handle);
 }
@@ -134,8 +139,7 @@ void window::request_close()
 {
 	if (impl_)
 	{
-		platform_event e;
-		std::memset(&e, 0, sizeof(e));
+		platform_event e{};
 		e.type = platform_event::closed;
 		impl_->push_event(e);
 	}
@@ -174,6 +178,31 @@ bool window::wait_event(platform_event& event)
 }
 
 
+////////////////////////////////////////////////////////////
+bool window::wait_for_events(std::int32_t timeout_ms)
+{
+    return priv::window_impl::wait_for_events(timeout_ms);
+}
+
+
+////////////////////////////////////////////////////////////
+void window::wake_up()
+{
+    priv::window_impl::wake_up();
+}
+
+
+////////////////////////////////////////////////////////////
+void window::set_event_callback(event_callback callback, void* user_data)
+{
+    callback_ = callback;
+    callback_user_data_ = user_data;
+
+    if (impl_)
+        impl_->set_event_callback(callback_ ? &window::forward_event : nullptr, this);
+}
+
+
 ////////////////////////////////////////////////////////////
 std::array<std::int32_t, 2> window::get_position() const
 {
@@ -382,8 +411,22 @@ void window::initialize()
     // Get and cache the initial size of the window
     size_ = impl_->get_size();
 
+    // Keep delivering to the callback across create() calls
+    if (callback_)
+        impl_->set_event_callback(&window::forward_event, this);
+
     // Notify the derived class
     on_create();
 }
 
+
+////////////////////////////////////////////////////////////
+void window::forward_event(const platform_event& event, void* user_data)
+{
+    window* self = static_cast<window*>(user_data);
+
+    if (self->filter_event(event))
+        self->callback_(event, self->callback_user_data_);
+}
+
 } // namespace mml
@@ -7,8 +7,6 @@
 #include <mml/window/sensor_manager.hpp>
 #include <algorithm>
 #include <cmath>
-#include <thread>
-#include <chrono>
 
 #if defined(MML_SYSTEM_WINDOWS)
 
@@ -23,6 +21,46 @@
 #endif
 
 
+namespace
+{
+    // Device states shared by all the windows
+    struct device_states
+    {
+        device_states() :
+        round(0)
+        {
+            // Get the initial joystick states
+            mml::priv::joystick_manager::get_instance().update();
+            for (unsigned int i = 0; i < mml::joystick::count; ++i)
+                joysticks[i] = mml::priv::joystick_manager::get_instance().get_state(i);
+
+            // Get the initial sensor states
+            for (unsigned int i = 0; i < mml::sensor::count; ++i)
+                sensors[i] = std::array<float, 3>({{ 0, 0, 0 }});
+        }
+
+        mml::priv::joystick_state joysticks[mml::joystick::count]; ///< Previous state of the joysticks
+        std::array<float, 3> sensors[mml::sensor::count];          ///< Previous value of the sensors
+        unsigned int round;                                        ///< Number of polling passes so far
+    };
+
+    device_states& get_device_states()
+    {
+        static device_states states;
+        return states;
+    }
+
+#if defined(MML_SYSTEM_LINUX)
+    // Joysticks wake up the OS wait and sensors aren't supported
+    const std::int32_t device_poll_interval = -1;
+#else
+    // Joysticks and sensors can't wake up the OS wait, so it is
+    // bounded to keep polling them
+    const std::int32_t device_poll_interval = 10;
+#endif
+}
+
+
 namespace mml
 {
 namespace priv
@@ -44,16 +82,11 @@ window_impl* window_impl::create(window_handle handle)
 
 ////////////////////////////////////////////////////////////
 window_impl::window_impl() :
-joystick_threshold_(0.1f)
+device_round_(get_device_states().round),
+joystick_threshold_(0.1f),
+callback_(nullptr),
+callback_user_data_(nullptr)
 {
-    // Get the initial joystick states
-    joystick_manager::get_instance().update();
-    for (unsigned int i = 0; i < joystick::count; ++i)
-        joystick_states_[i] = joystick_manager::get_instance().get_state(i);
-
-    // Get the initial sensor states
-    for (unsigned int i = 0; i < sensor::count; ++i)
-        sensor_value_[i] = std::array<float, 3>({{ 0, 0, 0 }});
 }
 
 
@@ -75,21 +108,16 @@ bool window_impl::pop_event(platform_event& event, bool block)
     if (events_.empty())
     {
         // Get events from the system
-        process_joystick_events();
-        process_sensor_events();
+        process_device_events();
         process_events();
 
         // In blocking mode, we must process events until one is triggered
         if (block)
         {
-            // Here we use a manual wait loop instead of the optimized
-            // wait-event provided by the OS, so that we don't skip joystick
-            // events (which require polling)
             while (events_.empty())
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                process_joystick_events();
-                process_sensor_events();
+                wait_for_events(device_poll_interval);
+                process_device_events();
                 process_events();
             }
         }
@@ -108,10 +136,53 @@ bool window_impl::pop_event(platform_event& event, bool block)
 }
 
 
+////////////////////////////////////////////////////////////
+bool window_impl::wait_for_events(std::int32_t timeout_ms)
+{
+    return window_impl_type::wait_for_events(timeout_ms);
+}
+
+
+////////////////////////////////////////////////////////////
+void window_impl::wake_up()
+{
+    window_impl_type::wake_up();
+}
+
+
 ////////////////////////////////////////////////////////////
 void window_impl::push_event(const platform_event& event)
 {
-    events_.push(event);
+    if (callback_)
+        callback_(event, callback_user_data_);
+    else
+        events_.push(event);
+}
+
+
+////////////////////////////////////////////////////////////
+void window_impl::set_event_callback(window::event_callback callback, void* user_data)
+{
+    callback_ = callback;
+    callback_user_data_ = user_data;
+}
+
+
+////////////////////////////////////////////////////////////
+void window_impl::process_device_events()
+{
+    device_states& states = get_device_states();
+
+    // Another window started a pass this window hasn't seen yet
+    if (device_round_ != states.round)
+    {
+        device_round_ = states.round;
+        return;
+    }
+
+    device_round_ = ++states.round;
+    process_joystick_events();
+    process_sensor_events();
 }
 
 
@@ -121,15 +192,16 @@ void window_impl::process_joystick_events()
     // First update the global joystick states
     joystick_manager::get_instance().update();
 
+    joystick_state* joystick_states = get_device_states().joysticks;
     for (unsigned int i = 0; i < joystick::count; ++i)
     {
         // Copy the previous state of the joystick and get the new one
-        joystick_state previousState = joystick_states_[i];
-        joystick_states_[i] = joystick_manager::get_instance().get_state(i);
+        joystick_state previousState = joystick_states[i];
+        joystick_states[i] = joystick_manager::get_instance().get_state(i);
         joystick_caps caps = joystick_manager::get_instance().get_capabilities(i);
 
         // Connection state
-        bool connected = joystick_states_[i].connected;
+        bool connected = joystick_states[i].connected;
         if (previousState.connected ^ connected)
         {
             platform_event event;
@@ -147,7 +219,7 @@ void window_impl::process_joystick_events()
                 {
                     auto axis = static_cast<joystick::axis>(j);
                     float prevPos = previousState.axes[axis];
-                    float currPos = joystick_states_[i].axes[axis];
+                    float currPos = joystick_states[i].axes[axis];
                     if (fabs(currPos - prevPos) >= joystick_threshold_)
                     {
                         platform_event event;
@@ -164,7 +236,7 @@ void window_impl::process_joystick_events()
             for (unsigned int j = 0; j < caps.button_count; ++j)
             {
                 bool prevPressed = previousState.buttons[j];
-                bool currPressed = joystick_states_[i].buttons[j];
+                bool currPressed = joystick_states[i].buttons[j];
 
                 if (prevPressed ^ currPressed)
                 {
@@ -186,6 +258,7 @@ void window_impl::process_sensor_events()
     // First update the sensor states
     sensor_manager::get_instance().update();
 
+    std::array<float, 3>* sensor_value = get_device_states().sensors;
     for (unsigned int i = 0; i < sensor::count; ++i)
     {
         auto sensor = static_cast<sensor::type>(i);
@@ -194,18 +267,18 @@ void window_impl::process_sensor_events()
         if (sensor_manager::get_instance().is_enabled(sensor))
         {
             // Copy the previous value of the sensor and get the new one
-            std::array<float, 3> previousValue = sensor_value_[i];
-            sensor_value_[i] = sensor_manager::get_instance().get_value(sensor);
+            std::array<float, 3> previousValue = sensor_value[i];
+            sensor_value[i] = sensor_manager::get_instance().get_value(sensor);
 
             // If the value has changed, trigger an event
-            if (sensor_value_[i] != previousValue) // @todo use a threshold?
+            if (sensor_value[i] != previousValue) // @todo use a threshold?
             {
                 platform_event event;
                 event.type = platform_event::sensor_changed;
                 event.sensor_ev.type = sensor;
-                event.sensor_ev.x = sensor_value_[i][0];
-                event.sensor_ev.y = sensor_value_[i][1];
-                event.sensor_ev.z = sensor_value_[i][2];
+                event.sensor_ev.x = sensor_value[i][0];
+                event.sensor_ev.y = sensor_value[i][1];
+                event.sensor_ev.z = sensor_value[i][2];
                 push_event(event);
             }
         }
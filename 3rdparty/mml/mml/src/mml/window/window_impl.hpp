@@ -90,6 +90,22 @@ public:
     ////////////////////////////////////////////////////////////
     bool pop_event(platform_event& event, bool block);
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Block until the OS has new events for any window
+    ///
+    /// \param timeout_ms Timeout in milliseconds, negative to wait forever
+    ///
+    /// \return True if events or a wake up arrived before the timeout
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool wait_for_events(std::int32_t timeout_ms);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Interrupt a thread blocked in wait_for_events
+    ///
+    ////////////////////////////////////////////////////////////
+    static void wake_up();
+
     ////////////////////////////////////////////////////////////
     /// \brief Get the OS-specific handle of the window
     ///
@@ -220,6 +236,16 @@ public:
 	////////////////////////////////////////////////////////////
 	void push_event(const platform_event& event);
 
+	////////////////////////////////////////////////////////////
+	/// \brief Hand new events over to \a callback instead of
+	///        queueing them
+	///
+	/// \param callback  Function to call for every event, or null to queue them
+	/// \param user_data Pointer passed back to \a callback
+	///
+	////////////////////////////////////////////////////////////
+	void set_event_callback(window::event_callback callback, void* user_data);
+
 protected:
 
     ////////////////////////////////////////////////////////////
@@ -236,6 +262,17 @@ protected:
 
 private:
 
+    ////////////////////////////////////////////////////////////
+    /// \brief Poll joysticks and sensors once per pass over the
+    ///        windows and generate the events on this window
+    ///
+    /// Devices are global, so only the first window polled in a
+    /// pass reads them and reports each change. The other windows
+    /// skip until the first one polls again.
+    ///
+    ////////////////////////////////////////////////////////////
+    void process_device_events();
+
     ////////////////////////////////////////////////////////////
     /// \brief Read the joysticks state and generate the appropriate events
     ///
@@ -253,12 +290,14 @@ private:
     ////////////////////////////////////////////////////////////
     ///< Queue of available events
 	std::queue<platform_event> events_;
-    ///< Previous state of the joysticks
-	joystick_state joystick_states_[joystick::count];
-    ///< Previous value of the sensors
-	std::array<float, 3> sensor_value_[sensor::count];
+    ///< Last device polling pass this window took part in
+	unsigned int device_round_;
 	///< joystick threshold (minimum motion for "move" event to be generated)
 	float joystick_threshold_;
+	///< Receives events instead of events_ when set
+	window::event_callback callback_;
+	///< Pointer passed back to callback_
+	void* callback_user_data_;
 };
 
 } // namespace priv
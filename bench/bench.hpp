@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+
+namespace bench
+{
+// Exit code ctest treats as skipped, e.g. when there is no display to open
+// windows on.
+constexpr int skipped = 77;
+
+using clock = std::chrono::steady_clock;
+
+inline auto elapsed_ns(clock::time_point start) -> double
+{
+	return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+}
+
+inline auto has_display() -> bool
+{
+#if defined(_WIN32) || defined(__APPLE__)
+	return true;
+#else
+	return std::getenv("DISPLAY") != nullptr || std::getenv("WAYLAND_DISPLAY") != nullptr;
+#endif
+}
+} // namespace bench
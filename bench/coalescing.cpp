@@ -0,0 +1,91 @@
+#include "bench.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+
+#include <array>
+#include <cstdio>
+
+// Synthetic 8 kHz mouse motion storm drained once per 60 Hz frame, with and
+// without event coalescing. Reports the queue depth seen by each frame and
+// the time to drain it, and checks that the relative motion adds up the same
+// either way.
+
+namespace
+{
+constexpr size_t motion_rate_hz = 8000;
+constexpr size_t frame_rate_hz = 60;
+constexpr size_t motions_per_frame = motion_rate_hz / frame_rate_hz;
+constexpr size_t frames = 300;
+
+std::array<os::event, 4096> buffer{};
+
+struct result
+{
+	double depth{};
+	double drain_ns{};
+	double xrel{};
+};
+
+auto run(bool coalescing) -> result
+{
+	os::set_event_coalescing(coalescing);
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+
+	result r{};
+	for(size_t frame = 0; frame < frames; ++frame)
+	{
+		os::event e{};
+		e.type = os::events::mouse_motion;
+		e.motion.xrel = 1.0f;
+		for(size_t i = 0; i < motions_per_frame; ++i)
+		{
+			e.motion.x = int32_t(i);
+			os::push_event(e);
+		}
+
+		const auto start = bench::clock::now();
+		const size_t drained = os::poll_events(buffer.data(), buffer.size());
+		r.drain_ns += bench::elapsed_ns(start);
+		for(size_t i = 0; i < drained; ++i)
+		{
+			if(buffer[i].type == os::events::mouse_motion)
+			{
+				r.depth += 1.0;
+				r.xrel += double(buffer[i].motion.xrel);
+			}
+		}
+	}
+
+	r.depth /= double(frames);
+	r.drain_ns /= double(frames);
+	return r;
+}
+} // namespace
+
+int main()
+{
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	const result plain = run(false);
+	const result coalesced = run(true);
+	os::set_event_coalescing(false);
+	os::shutdown();
+
+	std::printf("%zu motion events per frame, %zu frames\n", motions_per_frame, frames);
+	std::printf("%-12s %16s %16s\n", "coalescing", "events/frame", "drain ns/frame");
+	std::printf("%-12s %16.1f %16.1f\n", "off", plain.depth, plain.drain_ns);
+	std::printf("%-12s %16.1f %16.1f\n", "on", coalesced.depth, coalesced.drain_ns);
+
+	if(plain.xrel != coalesced.xrel)
+	{
+		std::printf("relative motion differs: %.1f vs %.1f\n", plain.xrel, coalesced.xrel);
+		return 1;
+	}
+	return 0;
+}
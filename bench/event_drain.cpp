@@ -0,0 +1,103 @@
+#include "bench.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+#include <ospp/window.h>
+
+#include <array>
+#include <cstdio>
+#include <memory>
+
+// Drains a burst of 500 queued events with the per-event poll_event loop from
+// the README, which pumps the backend once per event, and with a single
+// poll_events call. With a display a hidden window is open, so every pump
+// goes through the native event queue.
+
+namespace
+{
+constexpr size_t burst = 500;
+constexpr size_t rounds = 200;
+
+std::array<os::event, 512> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+void push_burst()
+{
+	os::event e{};
+	e.type = os::events::mouse_motion;
+	for(size_t i = 0; i < burst; ++i)
+	{
+		e.motion.x = int32_t(i);
+		os::push_event(e);
+	}
+}
+
+auto drain_one_by_one() -> size_t
+{
+	size_t drained = 0;
+	os::event e{};
+	while(os::poll_event(e))
+	{
+		++drained;
+	}
+	return drained;
+}
+
+auto drain_batch() -> size_t
+{
+	return os::poll_events(buffer.data(), buffer.size());
+}
+
+template <typename Drain>
+auto run(Drain drain) -> double
+{
+	double total_ns = 0.0;
+	for(size_t round = 0; round < rounds; ++round)
+	{
+		push_burst();
+		const auto start = bench::clock::now();
+		const size_t drained = drain();
+		total_ns += bench::elapsed_ns(start);
+		if(drained < burst)
+		{
+			std::printf("drained %zu of %zu events\n", drained, burst);
+		}
+		discard_pending();
+	}
+	return total_ns / double(rounds);
+}
+} // namespace
+
+int main()
+{
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	{
+		std::unique_ptr<os::window> window;
+		if(bench::has_display())
+		{
+			window.reset(new os::window("ospp bench", os::window::centered, os::window::centered, 64, 64,
+										os::window::hidden));
+		}
+		discard_pending();
+
+		const double single_ns = run(drain_one_by_one);
+		const double batch_ns = run(drain_batch);
+		std::printf("%s backend, %s\n", os::get_current_backend(), window ? "one hidden window" : "no window");
+		std::printf("%-24s %14s %14s\n", "drain of 500 events", "us/burst", "ns/event");
+		std::printf("%-24s %14.1f %14.1f\n", "poll_event loop", single_ns / 1000.0, single_ns / double(burst));
+		std::printf("%-24s %14.1f %14.1f\n", "poll_events", batch_ns / 1000.0, batch_ns / double(burst));
+	}
+
+	os::shutdown();
+	return 0;
+}
@@ -0,0 +1,103 @@
+#include "bench.hpp"
+
+#include <ospp/event.h>
+#include <ospp/mpsc_queue.hpp>
+
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Throughput of the queue behind push_event and poll_event with one to eight
+// producer threads and a single consumer, against the mutex guarded deque it
+// replaced.
+
+namespace
+{
+constexpr size_t events_per_run = 1 << 21;
+
+struct locked_deque
+{
+	auto try_push(const os::event& e) -> bool
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(e);
+		return true;
+	}
+
+	auto try_pop(os::event& e) -> bool
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(queue.empty())
+		{
+			return false;
+		}
+		e = queue.front();
+		queue.pop_front();
+		return true;
+	}
+
+	std::mutex mutex;
+	std::deque<os::event> queue;
+};
+
+template <typename Queue>
+auto run(Queue& queue, size_t producers) -> double
+{
+	const size_t per_producer = events_per_run / producers;
+	const size_t total = per_producer * producers;
+	const auto start = bench::clock::now();
+
+	std::vector<std::thread> threads;
+	for(size_t p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&queue, per_producer, p]() {
+			os::event e{};
+			e.type = os::events::mouse_motion;
+			e.motion.window_id = uint32_t(p);
+			for(size_t i = 0; i < per_producer; ++i)
+			{
+				while(!queue.try_push(e))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	os::event e{};
+	for(size_t received = 0; received < total;)
+	{
+		if(queue.try_pop(e))
+		{
+			++received;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+	return bench::elapsed_ns(start) / double(total);
+}
+} // namespace
+
+int main()
+{
+	static os::detail::mpsc_queue<os::event, 4096> lock_free;
+	static locked_deque locked;
+
+	std::printf("%-10s %22s %22s\n", "producers", "mpsc_queue ns/event", "deque+mutex ns/event");
+	for(size_t producers = 1; producers <= 8; producers *= 2)
+	{
+		const double lock_free_ns = run(lock_free, producers);
+		const double locked_ns = run(locked, producers);
+		std::printf("%-10zu %22.1f %22.1f\n", producers, lock_free_ns, locked_ns);
+	}
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include "bench.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+#include <ospp/keyboard.h>
+
+#include <array>
+#include <cstdio>
+
+// An action game checking 40 keys per frame: key::is_pressed for each key,
+// which asks the backend, against one key::get_state snapshot tested 40
+// times.
+
+namespace
+{
+constexpr size_t keys_per_frame = 40;
+constexpr size_t frames = 10000;
+
+auto make_keys() -> std::array<os::key::code, keys_per_frame>
+{
+	std::array<os::key::code, keys_per_frame> keys{};
+	for(size_t i = 0; i < keys_per_frame; ++i)
+	{
+		keys[i] = os::key::code(size_t(os::key::code::a) + i);
+	}
+	return keys;
+}
+
+const auto keys = make_keys();
+} // namespace
+
+int main()
+{
+	// queries open the display on X11
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	size_t down = 0;
+	auto start = bench::clock::now();
+	for(size_t frame = 0; frame < frames; ++frame)
+	{
+		for(auto key : keys)
+		{
+			down += os::key::is_pressed(key) ? 1 : 0;
+		}
+	}
+	const double query_ns = bench::elapsed_ns(start) / double(frames);
+
+	start = bench::clock::now();
+	for(size_t frame = 0; frame < frames; ++frame)
+	{
+		const auto state = os::key::get_state();
+		for(auto key : keys)
+		{
+			down += state.is_down(key) ? 1 : 0;
+		}
+	}
+	const double snapshot_ns = bench::elapsed_ns(start) / double(frames);
+
+	std::printf("%s backend, %zu keys per frame (%zu seen down)\n", os::get_current_backend(), keys_per_frame,
+				down);
+	std::printf("%-28s %14s\n", "", "ns/frame");
+	std::printf("%-28s %14.1f\n", "key::is_pressed per key", query_ns);
+	std::printf("%-28s %14.1f\n", "key::get_state snapshot", snapshot_ns);
+
+	os::shutdown();
+	return 0;
+}
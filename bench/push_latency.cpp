@@ -0,0 +1,89 @@
+#include "bench.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Latency from push_event on a producer thread to the consumer popping the
+// event, with the README's poll and sleep(16 ms) loop and with wait_event
+// sleeping in the backend until the push wakes it. Measured with the event's
+// timestamp, which push_event sets to os::now().
+
+namespace
+{
+constexpr size_t samples = 500;
+constexpr auto push_interval = std::chrono::microseconds(1500);
+
+template <typename Pop>
+void run(const char* name, Pop pop)
+{
+	std::vector<uint64_t> latencies;
+	latencies.reserve(samples);
+
+	std::thread producer([]() {
+		os::event e{};
+		e.type = os::events::mouse_motion;
+		for(size_t i = 0; i < samples; ++i)
+		{
+			std::this_thread::sleep_for(push_interval);
+			e.motion.x = int32_t(i);
+			os::push_event(e);
+		}
+	});
+
+	os::event e{};
+	while(latencies.size() < samples)
+	{
+		if(pop(e) && e.type == os::events::mouse_motion)
+		{
+			latencies.push_back(os::now() - e.timestamp);
+		}
+	}
+	producer.join();
+
+	std::sort(latencies.begin(), latencies.end());
+	double mean_ns = 0.0;
+	for(auto latency : latencies)
+	{
+		mean_ns += double(latency);
+	}
+	mean_ns /= double(samples);
+
+	std::printf("%-24s %10.1f %10.1f %10.1f\n", name, mean_ns / 1000.0, double(latencies[samples / 2]) / 1000.0,
+				double(latencies[samples * 99 / 100]) / 1000.0);
+}
+} // namespace
+
+int main()
+{
+	// waiting opens the display on X11
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	std::printf("%s backend, one event pushed every %.1f ms\n", os::get_current_backend(),
+				double(push_interval.count()) / 1000.0);
+	std::printf("%-24s %10s %10s %10s\n", "push to pop", "mean us", "p50 us", "p99 us");
+	run("poll + sleep 16 ms", [](os::event& e) {
+		if(os::poll_event(e))
+		{
+			return true;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(16));
+		return false;
+	});
+	run("wait_event", [](os::event& e) { return os::wait_event(e, 100); });
+
+	os::shutdown();
+	return 0;
+}
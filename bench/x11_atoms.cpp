@@ -0,0 +1,67 @@
+#include "bench.hpp"
+
+#include <ospp/clipboard.h>
+#include <ospp/init.h>
+#include <ospp/window.h>
+
+#include <cstdio>
+#include <memory>
+
+// Costs of the MML backend which used to intern atoms one round trip at a
+// time: creating the first window, which opens the display and fills the
+// atom table, creating further windows, and the first maximize and
+// clipboard access.
+
+namespace
+{
+constexpr size_t windows = 20;
+
+auto create_window() -> std::unique_ptr<os::window>
+{
+	return std::unique_ptr<os::window>(
+		new os::window("ospp bench", os::window::centered, os::window::centered, 64, 64, os::window::hidden));
+}
+} // namespace
+
+int main()
+{
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	{
+		auto start = bench::clock::now();
+		auto first = create_window();
+		const double first_ns = bench::elapsed_ns(start);
+
+		start = bench::clock::now();
+		for(size_t i = 0; i < windows; ++i)
+		{
+			create_window();
+		}
+		const double window_ns = bench::elapsed_ns(start) / double(windows);
+
+		start = bench::clock::now();
+		first->maximize();
+		const double maximize_ns = bench::elapsed_ns(start);
+
+		start = bench::clock::now();
+		os::clipboard::set_text("ospp bench");
+		const double clipboard_ns = bench::elapsed_ns(start);
+
+		std::printf("%-36s %12s\n", "", "us");
+		std::printf("%-36s %12.1f\n", "first window", first_ns / 1000.0);
+		std::printf("%-36s %12.1f\n", "next windows, create and destroy", window_ns / 1000.0);
+		std::printf("%-36s %12.1f\n", "first maximize", maximize_ns / 1000.0);
+		std::printf("%-36s %12.1f\n", "first clipboard set_text", clipboard_ns / 1000.0);
+	}
+
+	os::shutdown();
+	return 0;
+}
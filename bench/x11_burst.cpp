@@ -0,0 +1,101 @@
+#include "bench.hpp"
+#include "x11_sender.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+#include <ospp/window.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <thread>
+
+// Regression check for the MML pump: sends bursts of 50 motion events per
+// frame from a second X connection and drains once per frame with
+// poll_events. A pump that hands out one native event per window per frame
+// lets the backlog grow by the whole burst every frame; a pump that drains
+// the native queue keeps it within a burst or two and empties it at the end.
+
+namespace
+{
+constexpr size_t burst = 50;
+constexpr size_t frames = 300;
+constexpr size_t settle_frames = 100;
+constexpr size_t max_backlog = 2 * burst;
+
+std::array<os::event, 512> buffer{};
+
+auto drain(const os::window& win) -> size_t
+{
+	const size_t count = os::poll_events(buffer.data(), buffer.size());
+	return size_t(std::count_if(buffer.begin(), buffer.begin() + count, [&win](const os::event& e) {
+		return e.type == os::events::mouse_motion && e.motion.window_id == win.get_id();
+	}));
+}
+} // namespace
+
+int main()
+{
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	int result = 0;
+	{
+		bench::x11_sender sender;
+		if(!sender)
+		{
+			std::printf("cannot open a second X connection, skipping\n");
+			os::shutdown();
+			return bench::skipped;
+		}
+
+		os::window win("ospp bench", os::window::centered, os::window::centered, 64, 64, os::window::hidden);
+		while(os::poll_events(buffer.data(), buffer.size()) > 0)
+		{
+		}
+
+		size_t sent = 0;
+		size_t received = 0;
+		size_t worst_backlog = 0;
+		const auto start = bench::clock::now();
+		for(size_t frame = 0; frame < frames; ++frame)
+		{
+			for(size_t i = 0; i < burst; ++i)
+			{
+				sender.send_motion(win, int32_t(i), int32_t(frame % 64));
+			}
+			sender.sync();
+			sent += burst;
+
+			received += drain(win);
+			worst_backlog = std::max(worst_backlog, sent - received);
+		}
+		const double frame_ns = bench::elapsed_ns(start) / double(frames);
+
+		for(size_t frame = 0; frame < settle_frames && received < sent; ++frame)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			received += drain(win);
+		}
+
+		std::printf("%zu motion events per frame, %zu frames, %.1f us/frame\n", burst, frames,
+					frame_ns / 1000.0);
+		std::printf("worst backlog %zu events (limit %zu), left over %zu\n", worst_backlog, max_backlog,
+					sent - received);
+		if(worst_backlog > max_backlog || received != sent)
+		{
+			std::printf("FAILED: events are piling up between frames\n");
+			result = 1;
+		}
+	}
+
+	os::shutdown();
+	return result;
+}
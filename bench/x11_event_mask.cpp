@@ -0,0 +1,103 @@
+#include "bench.hpp"
+#include "x11_sender.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+#include <ospp/window.h>
+
+#include <array>
+#include <cstdio>
+
+// Pump cost of the MML backend with nothing pending, and the cost of pumping
+// 256 motion events sent from a second X connection with every event type
+// enabled and with mouse_motion masked out, in which case the backend drops
+// them before converting them.
+
+namespace
+{
+constexpr size_t events_per_round = 256;
+constexpr size_t rounds = 100;
+constexpr size_t idle_pumps = 10000;
+
+std::array<os::event, 512> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+auto idle_pump() -> double
+{
+	discard_pending();
+	const auto start = bench::clock::now();
+	for(size_t i = 0; i < idle_pumps; ++i)
+	{
+		os::poll_events(buffer.data(), buffer.size());
+	}
+	return bench::elapsed_ns(start) / double(idle_pumps);
+}
+
+// Time to pump a round of motion events, all of them already on the socket
+auto motion_pump(bench::x11_sender& sender, const os::window& win) -> double
+{
+	double total_ns = 0.0;
+	for(size_t round = 0; round < rounds; ++round)
+	{
+		discard_pending();
+		for(size_t i = 0; i < events_per_round; ++i)
+		{
+			sender.send_motion(win, int32_t(i % 64), int32_t(round % 64));
+		}
+		sender.sync();
+
+		const auto start = bench::clock::now();
+		os::poll_events(buffer.data(), buffer.size());
+		total_ns += bench::elapsed_ns(start);
+	}
+	return total_ns / double(rounds);
+}
+} // namespace
+
+int main()
+{
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	{
+		bench::x11_sender sender;
+		if(!sender)
+		{
+			std::printf("cannot open a second X connection, skipping\n");
+			os::shutdown();
+			return bench::skipped;
+		}
+
+		os::window win("ospp bench", os::window::centered, os::window::centered, 64, 64, os::window::hidden);
+
+		os::set_event_mask(os::all_events);
+		const double idle_ns = idle_pump();
+		const double all_ns = motion_pump(sender, win);
+
+		os::set_event_mask(os::all_events & ~os::event_bit(os::events::mouse_motion));
+		const double idle_masked_ns = idle_pump();
+		const double masked_ns = motion_pump(sender, win);
+		os::set_event_mask(os::all_events);
+
+		std::printf("%-24s %16s %22s\n", "event mask", "idle pump us", "pump 256 motion us");
+		std::printf("%-24s %16.2f %22.1f\n", "all events", idle_ns / 1000.0, all_ns / 1000.0);
+		std::printf("%-24s %16.2f %22.1f\n", "without mouse_motion", idle_masked_ns / 1000.0,
+					masked_ns / 1000.0);
+	}
+
+	os::shutdown();
+	return 0;
+}
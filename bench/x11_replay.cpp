@@ -0,0 +1,122 @@
+#include "bench.hpp"
+#include "x11_sender.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+#include <ospp/recording.h>
+#include <ospp/window.h>
+
+#include <array>
+#include <cstdio>
+
+// Cost of recording on the MML pump: 256 motion events sent from a second X
+// connection are pumped with and without a recording. The recording then
+// holds every pumped event, and is replayed as fast as possible through
+// poll_events to measure the replay throughput.
+
+namespace
+{
+constexpr size_t events_per_round = 256;
+constexpr size_t rounds = 100;
+constexpr const char* path = "ospp_bench_replay.bin";
+
+std::array<os::event, 512> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+// Time to pump a round of motion events, all of them already on the socket
+auto motion_pump(bench::x11_sender& sender, const os::window& win) -> double
+{
+	double total_ns = 0.0;
+	for(size_t round = 0; round < rounds; ++round)
+	{
+		for(size_t i = 0; i < events_per_round; ++i)
+		{
+			sender.send_motion(win, int32_t(i % 64), int32_t(round % 64));
+		}
+		sender.sync();
+
+		const auto start = bench::clock::now();
+		os::poll_events(buffer.data(), buffer.size());
+		total_ns += bench::elapsed_ns(start);
+		discard_pending();
+	}
+	return total_ns / double(rounds);
+}
+} // namespace
+
+int main()
+{
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	int result = 0;
+	{
+		bench::x11_sender sender;
+		if(!sender)
+		{
+			std::printf("cannot open a second X connection, skipping\n");
+			os::shutdown();
+			return bench::skipped;
+		}
+
+		os::window win("ospp bench", os::window::centered, os::window::centered, 64, 64, os::window::hidden);
+		discard_pending();
+
+		const double plain_ns = motion_pump(sender, win);
+
+		if(!os::start_event_recording(path))
+		{
+			std::printf("cannot create %s\n", path);
+			os::shutdown();
+			return 1;
+		}
+		const double recording_ns = motion_pump(sender, win);
+		os::stop_event_recording();
+
+		std::printf("%-24s %22s\n", "pump 256 motion", "us");
+		std::printf("%-24s %22.1f\n", "not recording", plain_ns / 1000.0);
+		std::printf("%-24s %22.1f\n", "recording", recording_ns / 1000.0);
+
+		if(!os::start_event_replay(path, os::replay_mode::as_fast_as_possible))
+		{
+			std::printf("FAILED: cannot replay %s\n", path);
+			result = 1;
+		}
+		else
+		{
+			size_t replayed = 0;
+			const auto start = bench::clock::now();
+			for(size_t count = 1; os::is_event_replaying() || count > 0;)
+			{
+				count = os::poll_events(buffer.data(), buffer.size());
+				replayed += count;
+			}
+			const double replay_ns = bench::elapsed_ns(start);
+
+			std::printf("replayed %zu events in %.1f ms, %.1f ns/event\n", replayed, replay_ns / 1e6,
+						replayed > 0 ? replay_ns / double(replayed) : 0.0);
+			if(replayed < events_per_round * rounds)
+			{
+				std::printf("FAILED: %zu motion events were sent while recording\n", events_per_round * rounds);
+				result = 1;
+			}
+		}
+	}
+
+	std::remove(path);
+	os::shutdown();
+	return result;
+}
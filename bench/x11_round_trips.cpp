@@ -0,0 +1,201 @@
+#include "bench.hpp"
+#include "x11_sender.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+#include <ospp/window.h>
+
+#include <xcb/xcb.h>
+#include <xcb/xcbext.h>
+
+#include <dlfcn.h>
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Counts the synchronous X11 round trips a typical frame costs the MML
+// backend: windows being dragged, 32 real configure events each per frame,
+// and a get_size plus get_position query.
+//
+// Every Xlib or XCB call that waits for a reply ends up in
+// xcb_wait_for_reply or xcb_wait_for_reply64. This executable defines both,
+// so the dynamic linker resolves the calls to them first. A wait counts as a
+// round trip when the reply hadn't arrived yet. Build mml with and without
+// the X11-xcb library to compare the two transports.
+
+namespace
+{
+constexpr size_t moves_per_frame = 32;
+constexpr size_t frames = 100;
+
+std::atomic<bool> counting(false);
+std::atomic<size_t> round_trips(0);
+
+template <typename Function>
+auto next_definition(Function*, const char* name) -> Function*
+{
+	return reinterpret_cast<Function*>(dlsym(RTLD_NEXT, name));
+}
+} // namespace
+
+extern "C" void* xcb_wait_for_reply(xcb_connection_t* c, unsigned int request, xcb_generic_error_t** e)
+{
+	static auto* wait = next_definition(&xcb_wait_for_reply, "xcb_wait_for_reply");
+	if(counting.load())
+	{
+		void* reply = nullptr;
+		if(e != nullptr)
+		{
+			*e = nullptr;
+		}
+		if(xcb_poll_for_reply(c, request, &reply, e) != 0)
+		{
+			return reply;
+		}
+		++round_trips;
+	}
+	return wait(c, request, e);
+}
+
+extern "C" void* xcb_wait_for_reply64(xcb_connection_t* c, uint64_t request, xcb_generic_error_t** e)
+{
+	static auto* wait = next_definition(&xcb_wait_for_reply64, "xcb_wait_for_reply64");
+	if(counting.load())
+	{
+		void* reply = nullptr;
+		if(e != nullptr)
+		{
+			*e = nullptr;
+		}
+		if(xcb_poll_for_reply64(c, request, &reply, e) != 0)
+		{
+			return reply;
+		}
+		++round_trips;
+	}
+	return wait(c, request, e);
+}
+
+namespace
+{
+std::array<os::event, 512> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+// Moves every window to its own final x and returns once each was reported
+// there, counting the round trips of the drain only.
+auto drag(bench::x11_sender& sender, const std::vector<std::unique_ptr<os::window>>& windows, int32_t base)
+	-> size_t
+{
+	for(size_t i = 0; i < moves_per_frame; ++i)
+	{
+		for(size_t w = 0; w < windows.size(); ++w)
+		{
+			sender.move_window(*windows[w], base + int32_t(i), base + int32_t(w));
+		}
+	}
+	sender.sync();
+	const int32_t last_x = base + int32_t(moves_per_frame) - 1;
+
+	std::vector<bool> arrived(windows.size(), false);
+	size_t remaining = windows.size();
+	const auto deadline = bench::clock::now() + std::chrono::seconds(1);
+
+	round_trips = 0;
+	counting = true;
+	while(remaining > 0 && bench::clock::now() < deadline)
+	{
+		const size_t count = os::poll_events(buffer.data(), buffer.size());
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto& e = buffer[i];
+			if(e.type != os::events::window || e.window.type != os::window_event_id::moved ||
+			   e.window.data1 != last_x)
+			{
+				continue;
+			}
+			for(size_t w = 0; w < windows.size(); ++w)
+			{
+				if(!arrived[w] && windows[w]->get_id() == e.window.window_id)
+				{
+					arrived[w] = true;
+					--remaining;
+				}
+			}
+		}
+	}
+	counting = false;
+	return round_trips;
+}
+
+void run(bench::x11_sender& sender, size_t window_count)
+{
+	std::vector<std::unique_ptr<os::window>> windows;
+	for(size_t i = 0; i < window_count; ++i)
+	{
+		windows.emplace_back(new os::window("ospp bench", 0, 0, 64, 64, os::window::hidden));
+	}
+	discard_pending();
+
+	size_t event_trips = 0;
+	size_t query_trips = 0;
+	for(size_t frame = 0; frame < frames; ++frame)
+	{
+		// Alternate between two ranges so every move changes the position
+		event_trips += drag(sender, windows, frame % 2 == 0 ? 100 : 200);
+
+		round_trips = 0;
+		counting = true;
+		const auto size = windows.front()->get_size();
+		const auto position = windows.front()->get_position();
+		counting = false;
+		query_trips += round_trips;
+		(void)size;
+		(void)position;
+	}
+
+	std::printf("%-8zu %24.2f %28.2f\n", window_count, double(event_trips) / double(frames),
+				double(query_trips) / double(frames));
+}
+} // namespace
+
+int main()
+{
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	{
+		bench::x11_sender sender;
+		if(!sender)
+		{
+			std::printf("cannot open a second X connection, skipping\n");
+			os::shutdown();
+			return bench::skipped;
+		}
+
+		std::printf("round trips per frame, %zu frames with %zu moves per window\n", frames, moves_per_frame);
+		std::printf("%-8s %24s %28s\n", "windows", "configure events", "get_size + get_position");
+		for(size_t window_count : {1, 8})
+		{
+			run(sender, window_count);
+		}
+	}
+
+	os::shutdown();
+	return 0;
+}
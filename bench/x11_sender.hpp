@@ -0,0 +1,79 @@
+#pragma once
+
+#include "bench.hpp"
+
+#include <ospp/window.h>
+
+#include <X11/Xlib.h>
+
+#include <cstdint>
+
+namespace bench
+{
+// A second X connection that sends synthetic input to our windows, so the
+// backend reads it from its own connection the way it reads real input.
+class x11_sender
+{
+public:
+	x11_sender()
+		: display_(XOpenDisplay(nullptr))
+	{
+	}
+
+	~x11_sender()
+	{
+		if(display_)
+		{
+			XCloseDisplay(display_);
+		}
+	}
+
+	x11_sender(const x11_sender&) = delete;
+	auto operator=(const x11_sender&) -> x11_sender& = delete;
+
+	explicit operator bool() const
+	{
+		return display_ != nullptr;
+	}
+
+	auto get_display() const -> Display*
+	{
+		return display_;
+	}
+
+	void send_motion(const os::window& win, int32_t x, int32_t y)
+	{
+		const auto target = handle(win);
+		XEvent ev{};
+		ev.xmotion.type = MotionNotify;
+		ev.xmotion.window = target;
+		ev.xmotion.root = DefaultRootWindow(display_);
+		ev.xmotion.x = x;
+		ev.xmotion.y = y;
+		ev.xmotion.same_screen = True;
+		XSendEvent(display_, target, False, PointerMotionMask, &ev);
+	}
+
+	// Moves the window from this connection, so the server generates real
+	// configure events for it. Synthetic ones carry root coordinates and skip
+	// the work a real one costs the backend.
+	void move_window(const os::window& win, int32_t x, int32_t y)
+	{
+		XMoveWindow(display_, handle(win), x, y);
+	}
+
+	// Returns once the server has processed everything sent so far.
+	void sync()
+	{
+		XSync(display_, False);
+	}
+
+private:
+	static auto handle(const os::window& win) -> ::Window
+	{
+		return ::Window(reinterpret_cast<uintptr_t>(win.get_native_handle()));
+	}
+
+	Display* display_{};
+};
+} // namespace bench
@@ -0,0 +1,156 @@
+#include "bench.hpp"
+#include "x11_sender.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+#include <ospp/window.h>
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+// Latency from a second X connection sending a motion event to an event
+// watch seeing it, against the same event popped by a consumer polling once
+// per 60 Hz frame. The input thread pumps the MML backend, so the watch runs
+// as soon as the event is read.
+
+namespace
+{
+constexpr size_t samples = 200;
+constexpr auto send_interval = std::chrono::milliseconds(5);
+constexpr auto frame_interval = std::chrono::microseconds(16667);
+
+using timeline = std::array<std::atomic<double>, samples>;
+
+const auto start = bench::clock::now();
+timeline sent_ns;
+timeline watched_ns;
+timeline popped_ns;
+
+// Sample index carried in the motion's x coordinate
+auto sample_of(const os::event& e, size_t& index) -> bool
+{
+	if(e.type != os::events::mouse_motion || e.motion.x < 0 || size_t(e.motion.x) >= samples)
+	{
+		return false;
+	}
+	index = size_t(e.motion.x);
+	return true;
+}
+
+auto watch(const os::event& e, void*) -> bool
+{
+	size_t index = 0;
+	if(sample_of(e, index))
+	{
+		watched_ns[index] = bench::elapsed_ns(start);
+	}
+	return false;
+}
+
+auto mean_after_send(const timeline& times) -> double
+{
+	double total_ns = 0.0;
+	size_t count = 0;
+	for(size_t i = 0; i < samples; ++i)
+	{
+		if(times[i].load() > 0.0)
+		{
+			total_ns += times[i].load() - sent_ns[i].load();
+			++count;
+		}
+	}
+	return count > 0 ? total_ns / double(count) : 0.0;
+}
+} // namespace
+
+int main()
+{
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	int result = 0;
+	{
+		os::window win("ospp bench", os::window::centered, os::window::centered, 64, 64, os::window::hidden);
+		std::array<os::event, 512> buffer{};
+		while(os::poll_events(buffer.data(), buffer.size()) > 0)
+		{
+		}
+
+		// before the input thread starts, this is the pumping thread
+		os::add_event_watch(&watch);
+		if(!os::start_input_thread())
+		{
+			std::printf("%s backend can't pump on another thread, skipping\n", os::get_current_backend());
+			os::remove_event_watch(&watch);
+			os::shutdown();
+			return bench::skipped;
+		}
+
+		std::atomic<bool> sender_failed(false);
+		std::thread sender_thread([&win, &sender_failed]() {
+			bench::x11_sender sender;
+			if(!sender)
+			{
+				sender_failed = true;
+				return;
+			}
+			for(size_t i = 0; i < samples; ++i)
+			{
+				std::this_thread::sleep_for(send_interval);
+				sent_ns[i] = bench::elapsed_ns(start);
+				sender.send_motion(win, int32_t(i), 0);
+				sender.sync();
+			}
+		});
+
+		// a consumer rendering at 60 Hz
+		size_t received = 0;
+		auto next_frame = bench::clock::now();
+		const auto deadline = next_frame + std::chrono::seconds(5);
+		while(received < samples && next_frame < deadline && !sender_failed)
+		{
+			next_frame += frame_interval;
+			std::this_thread::sleep_until(next_frame);
+
+			const size_t count = os::poll_events(buffer.data(), buffer.size());
+			for(size_t i = 0; i < count; ++i)
+			{
+				size_t index = 0;
+				if(sample_of(buffer[i], index) && popped_ns[index].load() == 0.0)
+				{
+					popped_ns[index] = bench::elapsed_ns(start);
+					++received;
+				}
+			}
+		}
+		sender_thread.join();
+		os::stop_input_thread();
+		os::remove_event_watch(&watch);
+
+		if(sender_failed)
+		{
+			std::printf("cannot open a second X connection, skipping\n");
+			result = bench::skipped;
+		}
+		else
+		{
+			std::printf("%zu motion events, one every %lld ms, %zu popped\n", samples,
+						static_cast<long long>(send_interval.count()), received);
+			std::printf("%-28s %14s\n", "send to", "mean us");
+			std::printf("%-28s %14.1f\n", "event watch", mean_after_send(watched_ns) / 1000.0);
+			std::printf("%-28s %14.1f\n", "poll_events at 60 Hz", mean_after_send(popped_ns) / 1000.0);
+		}
+	}
+
+	os::shutdown();
+	return result;
+}
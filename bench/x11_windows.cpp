@@ -0,0 +1,113 @@
+#include "bench.hpp"
+#include "x11_sender.hpp"
+
+#include <ospp/event.h>
+#include <ospp/init.h>
+#include <ospp/window.h>
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Cost of pumping the MML backend with 1, 8 and 32 windows open: an idle
+// pump with nothing pending, and draining 256 motion events sent round robin
+// to all windows from a second X connection.
+
+namespace
+{
+constexpr size_t events_per_round = 256;
+constexpr size_t rounds = 100;
+constexpr size_t idle_pumps = 1000;
+
+std::array<os::event, 512> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+auto count_motion(size_t count) -> size_t
+{
+	size_t motion = 0;
+	for(size_t i = 0; i < count; ++i)
+	{
+		motion += buffer[i].type == os::events::mouse_motion ? 1 : 0;
+	}
+	return motion;
+}
+
+void run(bench::x11_sender& sender, size_t window_count)
+{
+	std::vector<std::unique_ptr<os::window>> windows;
+	for(size_t i = 0; i < window_count; ++i)
+	{
+		windows.emplace_back(new os::window("ospp bench", os::window::centered, os::window::centered, 64, 64,
+											os::window::hidden));
+	}
+	discard_pending();
+
+	auto start = bench::clock::now();
+	for(size_t i = 0; i < idle_pumps; ++i)
+	{
+		os::poll_events(buffer.data(), buffer.size());
+	}
+	const double idle_ns = bench::elapsed_ns(start) / double(idle_pumps);
+
+	double drain_ns = 0.0;
+	size_t pumps = 0;
+	for(size_t round = 0; round < rounds; ++round)
+	{
+		for(size_t i = 0; i < events_per_round; ++i)
+		{
+			sender.send_motion(*windows[i % window_count], int32_t(i % 64), int32_t(round % 64));
+		}
+		sender.sync();
+
+		start = bench::clock::now();
+		const auto deadline = start + std::chrono::seconds(1);
+		for(size_t received = 0; received < events_per_round && bench::clock::now() < deadline; ++pumps)
+		{
+			received += count_motion(os::poll_events(buffer.data(), buffer.size()));
+		}
+		drain_ns += bench::elapsed_ns(start);
+	}
+
+	std::printf("%-8zu %16.1f %18.1f %16.1f\n", window_count, idle_ns / 1000.0, drain_ns / double(rounds) / 1000.0,
+				double(pumps) / double(rounds));
+}
+} // namespace
+
+int main()
+{
+	if(!bench::has_display())
+	{
+		std::printf("no display, skipping\n");
+		return bench::skipped;
+	}
+	if(!os::init())
+	{
+		return 1;
+	}
+
+	{
+		bench::x11_sender sender;
+		if(!sender)
+		{
+			std::printf("cannot open a second X connection, skipping\n");
+			os::shutdown();
+			return bench::skipped;
+		}
+
+		std::printf("%-8s %16s %18s %16s\n", "windows", "idle pump us", "drain 256 us", "pumps/drain");
+		for(size_t window_count : {1, 8, 32})
+		{
+			run(sender, window_count);
+		}
+	}
+
+	os::shutdown();
+	return 0;
+}
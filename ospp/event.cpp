@@ -1,5 +1,17 @@
 #include "event.h"
-#include <deque>
+#include "event_arena.hpp"
+#include "event_dispatch.hpp"
+#include "mpsc_queue.hpp"
+#include "recording.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
 
 #if defined(SDL_BACKEND)
 #include "impl/sdl/event.hpp"
@@ -18,41 +30,586 @@
 
 namespace os
 {
+static_assert(std::is_trivially_copyable<event>::value, "os::event must stay trivially copyable.");
+static_assert(sizeof(event) <= 64, "os::event must fit in a cache line.");
+static_assert(static_cast<size_t>(events::display_content_scale_changed) < 64, "events must fit in an event_mask.");
+
 namespace
 {
-auto get_event_queue() noexcept -> std::deque<event>&
+// Any thread may push, only the thread polling events pops.
+// When the queue is full new events are dropped.
+constexpr size_t event_queue_capacity = 4096;
+using event_queue_type = detail::mpsc_queue<event, event_queue_capacity>;
+
+auto get_event_queue() noexcept -> event_queue_type&
 {
-	static std::deque<event> event_queue;
+	static event_queue_type event_queue;
 	return event_queue;
 }
 
-auto pop_event(event& e) noexcept -> bool
+auto get_coalescing() noexcept -> std::atomic<bool>&
 {
-	auto& event_queue = get_event_queue();
-	// Pop the first event of the queue, if it is not empty
-	if(!event_queue.empty())
+	static std::atomic<bool> enabled{false};
+	return enabled;
+}
+
+auto get_mask() noexcept -> std::atomic<event_mask>&
+{
+	static std::atomic<event_mask> mask{all_events};
+	return mask;
+}
+
+// Queue position up to which the consumer is done with popped events and
+// their arena payloads. Published at the start of every poll/wait call.
+auto get_released() noexcept -> std::atomic<size_t>&
+{
+	static std::atomic<size_t> released{0};
+	return released;
+}
+
+// Queue position of the newest pumped event with an arena payload.
+// Only touched by the thread pumping events.
+struct arena_use
+{
+	size_t last_pos{};
+	bool in_use{};
+};
+
+auto get_arena_use() noexcept -> arena_use&
+{
+	static arena_use use;
+	return use;
+}
+
+struct input_thread_state
+{
+	std::atomic<bool> running{false};
+	std::atomic<bool> stop{false};
+	std::thread thread;
+	// lets the consumer sleep until the input thread queued something
+	std::mutex wait_mutex;
+	std::condition_variable wait_cv;
+};
+
+auto get_input_thread() noexcept -> input_thread_state&
+{
+	static input_thread_state state;
+	return state;
+}
+
+auto get_waiting() noexcept -> std::atomic<bool>&
+{
+	static std::atomic<bool> waiting{false};
+	return waiting;
+}
+
+auto is_waiting_thread() noexcept -> bool&
+{
+	static thread_local bool waiting = false;
+	return waiting;
+}
+
+auto is_coalescible(const event& e) noexcept -> bool
+{
+	return e.type == events::mouse_motion ||
+		   (e.type == events::window &&
+			(e.window.type == window_event_id::moved || e.window.type == window_event_id::resized));
+}
+
+auto coalesce(event& last, const event& e) noexcept -> bool
+{
+	if(last.type != e.type)
+	{
+		return false;
+	}
+
+	if(e.type == events::mouse_motion)
 	{
-		e = event_queue.front();
-		event_queue.pop_front();
+		if(last.motion.window_id != e.motion.window_id)
+		{
+			return false;
+		}
+		auto xrel = last.motion.xrel + e.motion.xrel;
+		auto yrel = last.motion.yrel + e.motion.yrel;
+		last.motion = e.motion;
+		last.motion.xrel = xrel;
+		last.motion.yrel = yrel;
+		last.timestamp = e.timestamp;
 		return true;
 	}
-	return false;
+
+	if(last.window.window_id != e.window.window_id || last.window.type != e.window.type)
+	{
+		return false;
+	}
+	last.window = e.window;
+	last.timestamp = e.timestamp;
+	return true;
+}
+
+auto stamped(const event& e) noexcept -> event
+{
+	event result = e;
+	if(result.timestamp == 0)
+	{
+		result.timestamp = now();
+	}
+	return result;
+}
+
+void wake_waiter() noexcept
+{
+	auto& input_thread = get_input_thread();
+	if(input_thread.running.load())
+	{
+		std::lock_guard<std::mutex> lock(input_thread.wait_mutex);
+		input_thread.wait_cv.notify_one();
+	}
+	else
+	{
+		impl::wake_up();
+	}
+}
+
+//-----------------------------------------------------------------------------
+/// Returns true if \a e was pushed as a new element, in which case \a pos
+/// receives its queue position. Merged and dropped events return false.
+//-----------------------------------------------------------------------------
+auto queue_event(const event& e, size_t& pos) noexcept -> bool
+{
+	auto& event_queue = get_event_queue();
+	bool pushed = false;
+	if(!get_coalescing().load(std::memory_order_relaxed) || !is_coalescible(e) ||
+	   !event_queue.try_merge_last([&e](event& last) { return coalesce(last, e); }))
+	{
+		pushed = event_queue.try_push(e, pos);
+	}
+
+	// Pairs with the fence in wait_event: either the waiter sees this event
+	// in the queue or we see it waiting. The queue publishes with release
+	// stores only, which a later load may pass without the fence. Backend
+	// callbacks running inside the wait don't need to wake it.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(get_waiting().load() && !is_waiting_thread())
+	{
+		wake_waiter();
+	}
+	return pushed;
+}
+
+struct event_watch_entry
+{
+	event_watch callback{};
+	void* user{};
+};
+
+// Only touched by the thread pumping events. Removed entries are nulled
+// and compacted once no dispatch is running, which keeps insertion order.
+struct event_watches
+{
+	std::array<event_watch_entry, max_event_watches> entries{};
+	size_t count{};
+	size_t dispatch_depth{};
+	bool has_removed{};
+};
+
+auto get_event_watches() noexcept -> event_watches&
+{
+	static event_watches watches;
+	return watches;
+}
+
+void compact(event_watches& watches) noexcept
+{
+	auto begin = std::begin(watches.entries);
+	auto end = std::remove_if(begin, begin + watches.count,
+							  [](const event_watch_entry& entry) { return entry.callback == nullptr; });
+	watches.count = static_cast<size_t>(end - begin);
+	watches.has_removed = false;
+}
+
+auto pop_event(event& e) noexcept -> bool
+{
+	return get_event_queue().try_pop(e);
+}
+
+//-----------------------------------------------------------------------------
+/// Called by the consumer before it pops: events popped by earlier calls,
+/// and their payloads, are no longer in use.
+//-----------------------------------------------------------------------------
+void release_popped() noexcept
+{
+	get_released().store(get_event_queue().popped(), std::memory_order_release);
+}
+
+auto is_input_thread_mode() noexcept -> bool
+{
+	return get_input_thread().running.load();
+}
+
+void pump_events() noexcept
+{
+	// Payloads the consumer may still read must survive this pump.
+	auto& use = get_arena_use();
+	if(!use.in_use || get_released().load(std::memory_order_acquire) > use.last_pos)
+	{
+		detail::get_event_arena().reset();
+		use.in_use = false;
+	}
+
+	// Backends may only reconfigure themselves from the pumping thread.
+	static event_mask applied_mask = all_events;
+	const auto mask = get_mask().load(std::memory_order_relaxed);
+	if(mask != applied_mask)
+	{
+		impl::apply_event_mask(mask);
+		applied_mask = mask;
+	}
+
+	impl::pump_events();
+
+	if(is_event_replaying())
+	{
+		// The consumer may be popping on another thread, so only count on
+		// the room it has released.
+		auto& event_queue = get_event_queue();
+		const auto used = event_queue.pushed() - get_released().load(std::memory_order_acquire);
+		detail::replay_events(event_queue.capacity() - used);
+	}
+}
+
+//-----------------------------------------------------------------------------
+/// Pumps until stopped. Sleeps in the backend between pumps, bounded by the
+/// backend's limit and the next replayed event. The consumer goes back to
+/// pumping itself only after the last pump here returned.
+//-----------------------------------------------------------------------------
+void input_loop(input_thread_state& state) noexcept
+{
+	while(!state.stop.load())
+	{
+		pump_events();
+
+		auto timeout = impl::max_input_thread_wait_ms();
+		const auto budget = detail::get_replay_wait_budget();
+		if(budget >= 0 && (timeout < 0 || budget < timeout))
+		{
+			timeout = budget;
+		}
+
+		// the wake up posted by stop_input_thread is not lost if it raced
+		// with this check, it makes the wait return immediately
+		if(!state.stop.load())
+		{
+			impl::wait_events(timeout);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(state.wait_mutex);
+		state.running = false;
+	}
+	state.wait_cv.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+/// Sleeps until the input thread queued something or stopped.
+//-----------------------------------------------------------------------------
+void wait_for_input_thread(int32_t timeout_ms) noexcept
+{
+	auto& state = get_input_thread();
+	auto ready = [&state] { return !get_event_queue().empty() || !state.running.load(); };
+
+	std::unique_lock<std::mutex> lock(state.wait_mutex);
+	if(timeout_ms < 0)
+	{
+		state.wait_cv.wait(lock, ready);
+	}
+	else
+	{
+		state.wait_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+	}
 }
 } // namespace
 
+namespace detail
+{
+auto get_event_arena() noexcept -> event_arena&
+{
+	static event_arena arena;
+	return arena;
+}
+
+void dispatch_event(const event& native) noexcept
+{
+	if(is_event_replaying())
+	{
+		return;
+	}
+
+	const auto e = stamped(native);
+	record_event(e);
+	inject_event(e);
+}
+
+void inject_event(const event& e) noexcept
+{
+	// before the watches, the state follows the devices even if they consume events
+	track_key_state(e);
+	track_mouse_state(e);
+
+	auto& watches = get_event_watches();
+	if(watches.count != 0)
+	{
+		bool consumed = false;
+		++watches.dispatch_depth;
+		for(size_t i = 0; i < watches.count && !consumed; ++i)
+		{
+			const auto entry = watches.entries[i];
+			consumed = entry.callback != nullptr && entry.callback(e, entry.user);
+		}
+		--watches.dispatch_depth;
+
+		if(watches.has_removed && watches.dispatch_depth == 0)
+		{
+			compact(watches);
+		}
+
+		if(consumed)
+		{
+			return;
+		}
+	}
+
+	size_t pos = 0;
+	if(queue_event(e, pos) && has_payload(e))
+	{
+		auto& use = get_arena_use();
+		use.last_pos = pos;
+		use.in_use = true;
+	}
+}
+
+void wake_pump() noexcept
+{
+	impl::wake_up();
+}
+} // namespace detail
+
 auto poll_event(event& e) noexcept -> bool
 {
-	impl::pump_events();
+	release_popped();
+	if(!is_input_thread_mode())
+	{
+		pump_events();
+	}
 
 	return pop_event(e);
 }
 
+auto poll_events(event* out, size_t max) noexcept -> size_t
+{
+	release_popped();
+	if(!is_input_thread_mode())
+	{
+		pump_events();
+	}
+
+	return get_event_queue().try_pop_bulk(out, max);
+}
+
+auto wait_event(event& e, int32_t timeout_ms) noexcept -> bool
+{
+	using clock = std::chrono::steady_clock;
+	const auto deadline = clock::now() + std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+
+	auto& waiting = get_waiting();
+	for(;;)
+	{
+		release_popped();
+		const bool input_thread_mode = is_input_thread_mode();
+		if(!input_thread_mode)
+		{
+			pump_events();
+		}
+		if(pop_event(e))
+		{
+			return true;
+		}
+
+		int32_t remaining = -1;
+		if(timeout_ms >= 0)
+		{
+			const auto left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - clock::now()).count();
+			if(left <= 0)
+			{
+				return false;
+			}
+			// round up so we don't spin through the last millisecond
+			remaining = static_cast<int32_t>((left + 999) / 1000);
+		}
+
+		// don't oversleep the next replayed event
+		const auto budget = detail::get_replay_wait_budget();
+		if(budget >= 0 && (remaining < 0 || budget < remaining))
+		{
+			remaining = budget;
+		}
+
+		waiting.store(true);
+		is_waiting_thread() = true;
+		// orders the store before the emptiness checks, see queue_event
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(input_thread_mode)
+		{
+			wait_for_input_thread(remaining);
+		}
+		else if(get_event_queue().empty())
+		{
+			impl::wait_events(remaining);
+		}
+		is_waiting_thread() = false;
+		waiting.store(false);
+	}
+}
+
 void push_event(const event& e)
 {
-	get_event_queue().emplace_back(e);
+	size_t pos = 0;
+	queue_event(stamped(e), pos);
 }
 void push_event(event&& e)
 {
-	get_event_queue().emplace_back(std::move(e));
+	size_t pos = 0;
+	queue_event(stamped(e), pos);
+}
+
+auto now() noexcept -> uint64_t
+{
+	return impl::now();
+}
+
+void set_event_coalescing(bool enabled) noexcept
+{
+	get_coalescing().store(enabled, std::memory_order_relaxed);
+}
+
+auto is_event_coalescing_enabled() noexcept -> bool
+{
+	return get_coalescing().load(std::memory_order_relaxed);
+}
+
+void set_event_mask(event_mask mask) noexcept
+{
+	get_mask().store(mask, std::memory_order_relaxed);
+}
+
+auto get_event_mask() noexcept -> event_mask
+{
+	return get_mask().load(std::memory_order_relaxed);
+}
+
+auto is_event_enabled(events type) noexcept -> bool
+{
+	return (get_mask().load(std::memory_order_relaxed) & event_bit(type)) != 0;
+}
+
+auto add_event_watch(event_watch callback, void* user) noexcept -> bool
+{
+	if(callback == nullptr)
+	{
+		return false;
+	}
+
+	auto& watches = get_event_watches();
+	if(watches.has_removed && watches.dispatch_depth == 0)
+	{
+		compact(watches);
+	}
+
+	if(watches.count == watches.entries.size())
+	{
+		return false;
+	}
+
+	watches.entries[watches.count++] = {callback, user};
+	return true;
+}
+
+void remove_event_watch(event_watch callback, void* user) noexcept
+{
+	auto& watches = get_event_watches();
+	for(size_t i = 0; i < watches.count; ++i)
+	{
+		auto& entry = watches.entries[i];
+		if(entry.callback == callback && entry.user == user)
+		{
+			entry.callback = nullptr;
+			watches.has_removed = true;
+			break;
+		}
+	}
+
+	if(watches.has_removed && watches.dispatch_depth == 0)
+	{
+		compact(watches);
+	}
+}
+
+auto start_input_thread() noexcept -> bool
+{
+	if(!impl::can_pump_from_any_thread())
+	{
+		return false;
+	}
+
+	auto& state = get_input_thread();
+	bool expected = false;
+	if(!state.running.compare_exchange_strong(expected, true))
+	{
+		return false;
+	}
+
+	if(state.thread.joinable())
+	{
+		state.thread.join();
+	}
+	state.stop = false;
+	state.thread = std::thread([&state] { input_loop(state); });
+	return true;
+}
+
+void run_input_loop() noexcept
+{
+	auto& state = get_input_thread();
+	bool expected = false;
+	if(!state.running.compare_exchange_strong(expected, true))
+	{
+		return;
+	}
+
+	state.stop = false;
+	input_loop(state);
+}
+
+void stop_input_thread() noexcept
+{
+	auto& state = get_input_thread();
+	if(!state.running.load())
+	{
+		return;
+	}
+
+	state.stop = true;
+	impl::wake_up();
+
+	if(state.thread.joinable() && state.thread.get_id() != std::this_thread::get_id())
+	{
+		state.thread.join();
+	}
+}
+
+auto is_input_thread_running() noexcept -> bool
+{
+	return get_input_thread().running.load();
 }
 } // namespace os
@@ -2,8 +2,9 @@
 
 #include "keyboard.h"
 #include "mouse.h"
+#include "types.hpp"
+#include <cstddef>
 #include <cstdint>
-#include <string>
 
 namespace os
 {
@@ -50,6 +51,7 @@ enum class events : uint8_t
 
 	mouse_button,
 	mouse_motion,
+	mouse_motion_raw,
 
 	finger_down,
 	finger_up,
@@ -94,10 +96,15 @@ struct window_event
 	window_event_id type{};
 };
 
+//-----------------------------------------------------------------------------
+/// Payloads of drop and text input events produced by the backend are
+/// valid until the next call to poll_event, poll_events or wait_event.
+/// Copy them with to_string() to keep them longer.
+//-----------------------------------------------------------------------------
 struct drop_event
 {
-	std::string source{}; /**< The source app that sent this drop event, or empty if that isn't available */
-	std::string data{};
+	text_view source{}; /**< The source app that sent this drop event, or empty if that isn't available */
+	text_view data{};
 	uint32_t window_id{};
 	float x{}; /**< X coordinate, relative to window (not on begin) */
 	float y{}; /**< Y coordinate, relative to window (not on begin) */
@@ -105,7 +112,7 @@ struct drop_event
 
 struct text_input_event
 {
-	std::string text{}; /**< The input text (utf8)*/
+	text_view text{}; /**< The input text (utf8)*/
 	uint32_t window_id{};
 };
 
@@ -123,10 +130,24 @@ struct mouse_button_event
 struct mouse_motion_event
 {
 	uint32_t window_id{};
-	int32_t x{};	 /**< X coordinate, relative to window */
-	int32_t y{};	 /**< Y coordinate, relative to window */
-	int32_t raw_x{}; /**< X coordinate, raw */
-	int32_t raw_y{}; /**< Y coordinate, raw */
+	float x{};	   /**< X coordinate, relative to window */
+	float y{};	   /**< Y coordinate, relative to window */
+	float raw_x{}; /**< X coordinate, raw */
+	float raw_y{}; /**< Y coordinate, raw */
+	float xrel{};  /**< Relative motion in the X direction */
+	float yrel{};  /**< Relative motion in the Y direction */
+};
+
+//-----------------------------------------------------------------------------
+/// Motion as reported by the device, before pointer acceleration and
+/// clamping to the screen. Only sent once mouse::set_raw_motion_enabled
+/// succeeded, see mouse.h.
+//-----------------------------------------------------------------------------
+struct mouse_motion_raw_event
+{
+	uint32_t window_id{}; /**< The focused window */
+	float dx{};			  /**< Motion in the X direction, in device units */
+	float dy{};			  /**< Motion in the Y direction, in device units */
 };
 
 struct mouse_wheel_event
@@ -145,6 +166,7 @@ struct key_event
 	bool ctrl{};	  /**< Is the Control key pressed? */
 	bool shift{};	  /**< Is the Shift key pressed? */
 	bool system{};	  /**< Is the System key pressed? */
+	bool repeat{};	  /**< Is this key_down generated by holding the key? */
 };
 
 struct display_event
@@ -163,25 +185,128 @@ struct gamepad_device_event
 
 struct event
 {
-	drop_event drop;
-	text_input_event text;
 	union
 	{
+		drop_event drop;
+		text_input_event text;
 		mouse_wheel_event wheel;
 		mouse_button_event button;
 		window_event window;
 		key_event key;
 		mouse_motion_event motion;
+		mouse_motion_raw_event motion_raw;
 		quit_event quit;
 		display_event display;
 		joystick_device_event joystick_device;
 		gamepad_device_event gamepad_device;
 	};
+	/// Nanoseconds in the time base of os::now(). Taken from the native
+	/// event when the backend provides one, otherwise when it was translated.
+	uint64_t timestamp{};
 	events type;
 };
 
+//-----------------------------------------------------------------------------
+/// Monotonic clock in nanoseconds, in the same time base as
+/// event::timestamp. now() - e.timestamp is how long the event waited.
+//-----------------------------------------------------------------------------
+auto now() noexcept -> uint64_t;
+
+//-----------------------------------------------------------------------------
+/// Safe to call from any thread. The queue is bounded, events pushed
+/// while it is full are dropped. A zero timestamp is set to now().
+//-----------------------------------------------------------------------------
 void push_event(event&& e);
 void push_event(const event& e);
 
 auto poll_event(event& e) noexcept -> bool;
+
+//-----------------------------------------------------------------------------
+/// When enabled, a pushed mouse_motion event is merged into a still queued
+/// mouse_motion event of the same window right before it (relative motion
+/// is accumulated), and the same is done for consecutive window moved or
+/// resized events. Disabled by default.
+//-----------------------------------------------------------------------------
+void set_event_coalescing(bool enabled) noexcept;
+auto is_event_coalescing_enabled() noexcept -> bool;
+
+//-----------------------------------------------------------------------------
+/// Set of event types, one bit per events value (see event_bit).
+//-----------------------------------------------------------------------------
+using event_mask = uint64_t;
+
+constexpr event_mask all_events = ~event_mask(0);
+
+constexpr auto event_bit(events type) noexcept -> event_mask
+{
+	return event_mask(1) << static_cast<uint8_t>(type);
+}
+
+//-----------------------------------------------------------------------------
+/// Backends drop event types missing from \a mask before converting them,
+/// SDL does not even generate them. The mask takes effect on the next pump.
+/// Events pushed with push_event are never filtered. Defaults to all_events.
+//-----------------------------------------------------------------------------
+void set_event_mask(event_mask mask) noexcept;
+auto get_event_mask() noexcept -> event_mask;
+auto is_event_enabled(events type) noexcept -> bool;
+
+//-----------------------------------------------------------------------------
+/// Called on the thread pumping events as soon as the backend translated
+/// an event, before it is queued. Return true to consume the event so it
+/// never reaches the queue. Events pushed with push_event are not watched.
+/// Watches run inside the backend's handling of the native event, which
+/// keeps using the window afterwards, so a watch must not destroy a window.
+/// Destroy it once poll_event, poll_events or wait_event returned.
+//-----------------------------------------------------------------------------
+using event_watch = bool (*)(const event& e, void* user);
+
+constexpr size_t max_event_watches = 8;
+
+//-----------------------------------------------------------------------------
+/// Watches run in the order they were added. Must be called from the thread
+/// pumping events, removing from inside a watch is allowed. Returns false
+/// if max_event_watches are already registered.
+//-----------------------------------------------------------------------------
+auto add_event_watch(event_watch callback, void* user = nullptr) noexcept -> bool;
+void remove_event_watch(event_watch callback, void* user = nullptr) noexcept;
+
+//-----------------------------------------------------------------------------
+/// Pumps the backend once and moves up to \a max queued events into \a out.
+/// Returns the number of events written. Prefer this over calling
+/// poll_event in a loop when draining many events per frame.
+//-----------------------------------------------------------------------------
+auto poll_events(event* out, size_t max) noexcept -> size_t;
+
+//-----------------------------------------------------------------------------
+/// Blocks until an event is available and pops it. Returns false if none
+/// arrived within \a timeout_ms milliseconds, a negative timeout waits
+/// forever. The thread sleeps in the backend's native wait and is woken up
+/// by push_event from other threads.
+//-----------------------------------------------------------------------------
+auto wait_event(event& e, int32_t timeout_ms = -1) noexcept -> bool;
+
+//-----------------------------------------------------------------------------
+/// Moves pumping off the consumer: a dedicated thread pumps the backend and
+/// sleeps in its native wait, so events are timestamped and queued while
+/// the consumer is busy rendering. poll_event, poll_events and wait_event
+/// then only pop the queue. Watches run on the input thread.
+/// Returns false if the backend must be pumped on the thread that called
+/// os::init (SDL, GLFW, MML on Windows), use run_input_loop there instead.
+//-----------------------------------------------------------------------------
+auto start_input_thread() noexcept -> bool;
+
+//-----------------------------------------------------------------------------
+/// Same as start_input_thread but pumps on the calling thread, blocking
+/// until stop_input_thread is called from another thread. For backends
+/// pinned to the init thread, which must then run the app elsewhere.
+//-----------------------------------------------------------------------------
+void run_input_loop() noexcept;
+
+//-----------------------------------------------------------------------------
+/// Stops the input loop and joins a thread started by start_input_thread.
+/// A consumer blocked in wait_event is woken up and pumps itself again.
+//-----------------------------------------------------------------------------
+void stop_input_thread() noexcept;
+auto is_input_thread_running() noexcept -> bool;
 } // namespace os
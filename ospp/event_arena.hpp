@@ -0,0 +1,152 @@
+#pragma once
+
+#include "event.h"
+#include "types.hpp"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace os
+{
+namespace detail
+{
+//-----------------------------------------------------------------------------
+/// Bump allocator for the variable-length payloads of events (text input,
+/// drop paths). Only the thread pumping the backend writes to it. Chunks
+/// are kept across resets so steady state pumping does not allocate.
+//-----------------------------------------------------------------------------
+class event_arena
+{
+public:
+	static constexpr size_t chunk_size = 4096;
+
+	//-----------------------------------------------------------------------------
+	/// Copies \a size bytes, adds a null terminator and returns a view
+	/// which stays valid until the next reset.
+	//-----------------------------------------------------------------------------
+	auto store(const char* data, size_t size) -> text_view
+	{
+		if(data == nullptr || size == 0)
+		{
+			return {};
+		}
+
+		auto dst = allocate(size + 1);
+		std::memcpy(dst, data, size);
+		dst[size] = '\0';
+		return {dst, size};
+	}
+
+	auto store(const char* str) -> text_view
+	{
+		return str ? store(str, std::strlen(str)) : text_view{};
+	}
+
+	auto store_utf8(uint32_t codepoint) -> text_view
+	{
+		char buf[4]{};
+		size_t size = 0;
+		if(codepoint < 0x80)
+		{
+			buf[size++] = static_cast<char>(codepoint);
+		}
+		else if(codepoint < 0x800)
+		{
+			buf[size++] = static_cast<char>(0xC0 | (codepoint >> 6));
+			buf[size++] = static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		else if(codepoint < 0x10000)
+		{
+			buf[size++] = static_cast<char>(0xE0 | (codepoint >> 12));
+			buf[size++] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+			buf[size++] = static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		else if(codepoint < 0x110000)
+		{
+			buf[size++] = static_cast<char>(0xF0 | (codepoint >> 18));
+			buf[size++] = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+			buf[size++] = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+			buf[size++] = static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		return store(buf, size);
+	}
+
+	void reset() noexcept
+	{
+		current_ = 0;
+		offset_ = 0;
+	}
+
+private:
+	struct chunk
+	{
+		std::unique_ptr<char[]> data;
+		size_t size{};
+	};
+
+	auto allocate(size_t size) -> char*
+	{
+		while(current_ < chunks_.size())
+		{
+			auto& c = chunks_[current_];
+			if(offset_ + size <= c.size)
+			{
+				auto result = c.data.get() + offset_;
+				offset_ += size;
+				return result;
+			}
+			++current_;
+			offset_ = 0;
+		}
+
+		chunk c;
+		c.size = size > chunk_size ? size : chunk_size;
+		c.data.reset(new char[c.size]);
+		chunks_.emplace_back(std::move(c));
+		offset_ = size;
+		return chunks_.back().data.get();
+	}
+
+	std::vector<chunk> chunks_;
+	size_t current_{};
+	size_t offset_{};
+};
+
+//-----------------------------------------------------------------------------
+/// The arena backing payloads of the events produced by the current pump.
+//-----------------------------------------------------------------------------
+auto get_event_arena() noexcept -> event_arena&;
+
+//-----------------------------------------------------------------------------
+/// Calls \a f with every text_view payload of \a e, in a fixed order.
+//-----------------------------------------------------------------------------
+template <typename Event, typename F>
+void for_each_payload(Event& e, F&& f)
+{
+	switch(e.type)
+	{
+		case events::text_input:
+			f(e.text.text);
+			break;
+		case events::drop_file:
+		case events::drop_text:
+		case events::drop_begin:
+		case events::drop_complete:
+		case events::drop_position:
+			f(e.drop.source);
+			f(e.drop.data);
+			break;
+		default:
+			break;
+	}
+}
+
+inline auto has_payload(const event& e) noexcept -> bool
+{
+	bool result = false;
+	for_each_payload(e, [&result](const text_view&) { result = true; });
+	return result;
+}
+} // namespace detail
+} // namespace os
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "event.h"
+
+namespace os
+{
+namespace detail
+{
+//-----------------------------------------------------------------------------
+/// Entry point for events translated by a backend. Records the event, runs
+/// the event watches and queues it unless one of them consumed it. Ignored
+/// while a recording is being replayed.
+/// Must only be called from the thread pumping events.
+//-----------------------------------------------------------------------------
+void dispatch_event(const event& e) noexcept;
+
+//-----------------------------------------------------------------------------
+/// Runs the event watches and queues a replayed event.
+//-----------------------------------------------------------------------------
+void inject_event(const event& e) noexcept;
+
+//-----------------------------------------------------------------------------
+/// Updates the keyboard state returned by key::get_state (see keyboard.cpp).
+/// Must only be called from the thread pumping events.
+//-----------------------------------------------------------------------------
+void track_key_state(const event& e) noexcept;
+
+//-----------------------------------------------------------------------------
+/// Updates the pointer state kept in mouse.cpp: the motion history, the
+/// cached position in the hovered window, the pressed buttons and the raw
+/// motion returned by mouse::take_raw_motion.
+/// Must only be called from the thread pumping events.
+//-----------------------------------------------------------------------------
+void track_mouse_state(const event& e) noexcept;
+
+//-----------------------------------------------------------------------------
+/// Appends \a e to the active recording, if any (see recording.cpp).
+//-----------------------------------------------------------------------------
+void record_event(const event& e) noexcept;
+
+//-----------------------------------------------------------------------------
+/// Injects up to \a max due events of the active replay.
+//-----------------------------------------------------------------------------
+void replay_events(size_t max) noexcept;
+
+//-----------------------------------------------------------------------------
+/// Interrupts a thread sleeping in the backend, so it pumps again and picks
+/// up a replay started from another thread.
+//-----------------------------------------------------------------------------
+void wake_pump() noexcept;
+
+//-----------------------------------------------------------------------------
+/// Milliseconds until the next replayed event is due, -1 when not replaying.
+//-----------------------------------------------------------------------------
+auto get_replay_wait_budget() noexcept -> int32_t;
+} // namespace detail
+} // namespace os
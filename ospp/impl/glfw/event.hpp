@@ -1,15 +1,15 @@
 #pragma once
 #include "../../event.h"
+#include "../../event_arena.hpp"
+#include "../../event_dispatch.hpp"
 
 #include "keyboard.hpp"
 #include "mouse.hpp"
 #include "window.hpp"
 
-#include <codecvt>
+#include <chrono>
 #include <cstring>
-#include <deque>
 #include <iostream>
-#include <locale>
 
 namespace os
 {
@@ -45,12 +45,17 @@ inline void set_callbacks(GLFWwindow* window)
 							   {
 								   auto win_impl = get_impl(window);
 
+								   if(!is_event_enabled(events::window))
+								   {
+									   return;
+								   }
+
 								   event ev{};
 								   ev.type = events::window;
 								   ev.window.window_id = win_impl->get_id();
 								   ev.window.type = window_event_id::close;
 
-								   push_event(std::move(ev));
+								   dispatch_event(ev);
 							   });
 
 	glfwSetWindowFocusCallback(window,
@@ -72,13 +77,18 @@ inline void set_callbacks(GLFWwindow* window)
 									   }
 								   }
 
+								   if(!is_event_enabled(events::window))
+								   {
+									   return;
+								   }
+
 								   event ev{};
 								   ev.type = events::window;
 								   ev.window.window_id = win_impl->get_id();
 								   ev.window.type = focused == GL_TRUE ? window_event_id::focus_gained
 																	   : window_event_id::focus_lost;
 
-								   push_event(std::move(ev));
+								   dispatch_event(ev);
 							   });
 
 	glfwSetWindowSizeCallback(window,
@@ -86,6 +96,11 @@ inline void set_callbacks(GLFWwindow* window)
 							  {
 								  auto win_impl = get_impl(window);
 
+								  if(!is_event_enabled(events::window))
+								  {
+									  return;
+								  }
+
 								  event ev{};
 								  ev.type = events::window;
 								  ev.window.window_id = win_impl->get_id();
@@ -93,7 +108,7 @@ inline void set_callbacks(GLFWwindow* window)
 								  ev.window.data1 = static_cast<int32_t>(w);
 								  ev.window.data2 = static_cast<int32_t>(h);
 
-								  push_event(std::move(ev));
+								  dispatch_event(ev);
 							  });
 
 	glfwSetWindowPosCallback(window,
@@ -101,6 +116,11 @@ inline void set_callbacks(GLFWwindow* window)
 							 {
 								 auto win_impl = get_impl(window);
 
+								 if(!is_event_enabled(events::window))
+								 {
+									 return;
+								 }
+
 								 event ev{};
 								 ev.type = events::window;
 								 ev.window.window_id = win_impl->get_id();
@@ -108,7 +128,7 @@ inline void set_callbacks(GLFWwindow* window)
 								 ev.window.data1 = static_cast<int32_t>(x);
 								 ev.window.data2 = static_cast<int32_t>(y);
 
-								 push_event(std::move(ev));
+								 dispatch_event(ev);
 							 });
 
 	glfwSetWindowMaximizeCallback(window,
@@ -116,13 +136,18 @@ inline void set_callbacks(GLFWwindow* window)
 								  {
 									  auto win_impl = get_impl(window);
 
+									  if(!is_event_enabled(events::window))
+									  {
+										  return;
+									  }
+
 									  event ev{};
 									  ev.type = events::window;
 									  ev.window.window_id = win_impl->get_id();
 									  ev.window.type = mode == GLFW_TRUE ? window_event_id::maximized
 																		 : window_event_id::restored;
 
-									  push_event(std::move(ev));
+									  dispatch_event(ev);
 								  });
 
 	glfwSetCursorEnterCallback(window,
@@ -130,13 +155,18 @@ inline void set_callbacks(GLFWwindow* window)
 							   {
 								   auto win_impl = get_impl(window);
 
+								   if(!is_event_enabled(events::window))
+								   {
+									   return;
+								   }
+
 								   event ev{};
 								   ev.type = events::window;
 								   ev.window.window_id = win_impl->get_id();
 								   ev.window.type =
 									   mode == GLFW_TRUE ? window_event_id::enter : window_event_id::leave;
 
-								   push_event(std::move(ev));
+								   dispatch_event(ev);
 							   });
 
 	glfwSetCursorPosCallback(window,
@@ -144,13 +174,25 @@ inline void set_callbacks(GLFWwindow* window)
 							 {
 								 auto win_impl = get_impl(window);
 
+								 // keep tracking while masked so xrel stays correct once enabled
+								 pointf pos{static_cast<float>(x), static_cast<float>(y)};
+								 auto rel = win_impl->update_cursor_position(pos);
+								 if(!is_event_enabled(events::mouse_motion))
+								 {
+									 return;
+								 }
+
 								 event ev{};
 								 ev.type = events::mouse_motion;
 								 ev.motion.window_id = win_impl->get_id();
-								 ev.motion.x = static_cast<int32_t>(x);
-								 ev.motion.y = static_cast<int32_t>(y);
-
-								 push_event(std::move(ev));
+								 ev.motion.x = pos.x;
+								 ev.motion.y = pos.y;
+								 ev.motion.raw_x = pos.x;
+								 ev.motion.raw_y = pos.y;
+								 ev.motion.xrel = rel.x;
+								 ev.motion.yrel = rel.y;
+
+								 dispatch_event(ev);
 							 });
 
 	glfwSetMouseButtonCallback(window,
@@ -158,22 +200,23 @@ inline void set_callbacks(GLFWwindow* window)
 							   {
 								   auto win_impl = get_impl(window);
 
-								   point pos{};
-								   double x{};
-								   double y{};
-								   glfwGetCursorPos(win_impl->get_impl(), &x, &y);
-								   pos.x = static_cast<int32_t>(x);
-								   pos.y = static_cast<int32_t>(y);
+								   if(!is_event_enabled(events::mouse_button))
+								   {
+									   return;
+								   }
+
+								   // the cursor callback keeps it, querying is a round trip on X11
+								   const auto pos = win_impl->get_cursor_position();
 
 								   event ev{};
 								   ev.type = events::mouse_button;
 								   ev.button.window_id = win_impl->get_id();
 								   ev.button.button = mouse::detail::glfw::from_impl(button);
 								   ev.button.state_id = to_state(action);
-								   ev.button.x = pos.x;
-								   ev.button.y = pos.y;
+								   ev.button.x = static_cast<int32_t>(pos.x);
+								   ev.button.y = static_cast<int32_t>(pos.y);
 
-								   push_event(std::move(ev));
+								   dispatch_event(ev);
 							   });
 
 	glfwSetScrollCallback(window,
@@ -181,13 +224,18 @@ inline void set_callbacks(GLFWwindow* window)
 						  {
 							  auto win_impl = get_impl(window);
 
+							  if(!is_event_enabled(events::mouse_wheel))
+							  {
+								  return;
+							  }
+
 							  event ev{};
 							  ev.type = events::mouse_wheel;
 							  ev.wheel.window_id = win_impl->get_id();
 							  ev.wheel.x = xoffs;
 							  ev.wheel.y = yoffs;
 
-							  push_event(std::move(ev));
+							  dispatch_event(ev);
 						  });
 
 	glfwSetCharModsCallback(window,
@@ -195,14 +243,17 @@ inline void set_callbacks(GLFWwindow* window)
 							{
 								auto win_impl = get_impl(window);
 
+								if(!is_event_enabled(events::text_input))
+								{
+									return;
+								}
+
 								event ev{};
 								ev.type = events::text_input;
 								ev.text.window_id = win_impl->get_id();
-								ev.text.text =
-									std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t>{}.to_bytes(
-										unicode_codepoint);
+								ev.text.text = get_event_arena().store_utf8(unicode_codepoint);
 
-								push_event(std::move(ev));
+								dispatch_event(ev);
 							});
 	glfwSetKeyCallback(window,
 					   [](GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -210,20 +261,32 @@ inline void set_callbacks(GLFWwindow* window)
 						   auto win_impl = get_impl(window);
 
 						   (void)scancode;
+						   const auto type = action == GLFW_RELEASE ? events::key_up : events::key_down;
+						   if(!is_event_enabled(type))
+						   {
+							   return;
+						   }
+
 						   event ev{};
-						   ev.type = action == GLFW_RELEASE ? events::key_up : events::key_down;
+						   ev.type = type;
 						   ev.key.window_id = win_impl->get_id();
 						   ev.key.code = detail::glfw::from_layout_independent_impl(key);
 						   ev.key.alt = (mods & GLFW_MOD_ALT) != 0;
 						   ev.key.ctrl = (mods & GLFW_MOD_CONTROL) != 0;
 						   ev.key.shift = (mods & GLFW_MOD_SHIFT) != 0;
 						   ev.key.system = (mods & GLFW_MOD_SUPER) != 0;
-						   push_event(std::move(ev));
+						   ev.key.repeat = action == GLFW_REPEAT;
+						   dispatch_event(ev);
 					   });
 
 	glfwSetDropCallback(window,
 						[](GLFWwindow* window, int count, const char** paths)
 						{
+							if(!is_event_enabled(events::drop_file))
+							{
+								return;
+							}
+
 							auto win_impl = get_impl(window);
 
 							for(int i = 0; i < count; ++i)
@@ -231,8 +294,8 @@ inline void set_callbacks(GLFWwindow* window)
 								event ev{};
 								ev.type = events::drop_file;
 								ev.drop.window_id = win_impl->get_id();
-								ev.drop.data = paths[i];
-								push_event(std::move(ev));
+								ev.drop.data = get_event_arena().store(paths[i]);
+								dispatch_event(ev);
 							}
 						});
 
@@ -254,7 +317,10 @@ inline void set_callbacks(GLFWwindow* window)
 					ev.joystick_device.which = jid;
 					ev.type = events::joystic_added;
 				}
-				push_event(std::move(ev));
+				if(is_event_enabled(ev.type))
+				{
+					dispatch_event(ev);
+				}
 			}
 			else if(e == GLFW_DISCONNECTED)
 			{
@@ -270,7 +336,10 @@ inline void set_callbacks(GLFWwindow* window)
 					ev.joystick_device.which = jid;
 					ev.type = events::joystic_removed;
 				}
-				push_event(std::move(ev));
+				if(is_event_enabled(ev.type))
+				{
+					dispatch_event(ev);
+				}
 			}
 		});
 
@@ -297,13 +366,25 @@ inline void set_callbacks(GLFWwindow* window)
 	glfwSetWindowContentScaleCallback(window,
 									  [](GLFWwindow* window, float xscale, float yscale) {
 
+										  if(!is_event_enabled(events::display_content_scale_changed))
+										  {
+											  return;
+										  }
+
 										  event ev{};
 										  ev.type = events::display_content_scale_changed;
-										  push_event(std::move(ev));
+										  dispatch_event(ev);
 
 									  });
 }
 
+//-----------------------------------------------------------------------------
+/// The callbacks check the mask themselves, nothing to configure.
+//-----------------------------------------------------------------------------
+inline void apply_event_mask(event_mask) noexcept
+{
+}
+
 inline void pump_events() noexcept
 {
 	glfwPollEvents();
@@ -318,12 +399,59 @@ inline void pump_events() noexcept
 		{
 			reported = true;
 
-			event ev{};
-			ev.type = events::quit;
-			push_event(std::move(ev));
+			if(is_event_enabled(events::quit))
+			{
+				event ev{};
+				ev.type = events::quit;
+				dispatch_event(ev);
+			}
 		}
 	}
 }
+
+//-----------------------------------------------------------------------------
+/// GLFW callbacks carry no time, events are stamped when translated.
+//-----------------------------------------------------------------------------
+inline auto now() noexcept -> uint64_t
+{
+	using namespace std::chrono;
+	return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+inline void wait_events(int32_t timeout_ms) noexcept
+{
+	if(timeout_ms < 0)
+	{
+		glfwWaitEvents();
+	}
+	else if(timeout_ms == 0)
+	{
+		// glfwWaitEventsTimeout rejects a timeout that isn't positive
+		glfwPollEvents();
+	}
+	else
+	{
+		glfwWaitEventsTimeout(timeout_ms / 1000.0);
+	}
+}
+
+inline void wake_up() noexcept
+{
+	glfwPostEmptyEvent();
+}
+
+//-----------------------------------------------------------------------------
+/// GLFW only allows processing events on the main thread.
+//-----------------------------------------------------------------------------
+inline auto can_pump_from_any_thread() noexcept -> bool
+{
+	return false;
+}
+
+inline auto max_input_thread_wait_ms() noexcept -> int32_t
+{
+	return -1;
+}
 } // namespace glfw
 } // namespace detail
 } // namespace os
@@ -24,17 +24,19 @@ inline auto init() -> int
 
     glfwSetMonitorCallback([](GLFWmonitor* monitor, int e)
     {
+        event ev{};
         if(e == GLFW_DISCONNECTED)
         {
-            event ev{};
             ev.type = events::display_disconnected;
-            push_event(std::move(ev));
         }
         else if(e == GLFW_CONNECTED)
         {
-            event ev{};
             ev.type = events::display_connected;
-            push_event(std::move(ev));
+        }
+
+        if(ev.type != events::unknown && is_event_enabled(ev.type))
+        {
+            dispatch_event(ev);
         }
     });
 
@@ -59,7 +59,7 @@ inline auto is_button_pressed(button b) noexcept -> bool
 	auto focused_win = os::detail::glfw::get_focused_win();
 	if(focused_win)
 	{
-		return glfwGetKey(focused_win->get_impl(), impl_button) != GLFW_RELEASE;
+		return glfwGetMouseButton(focused_win->get_impl(), impl_button) == GLFW_PRESS;
 	}
 	return false;
 }
@@ -92,6 +92,13 @@ inline auto get_position() noexcept -> point
 	return {};
 }
 
+inline auto latch_position(const window& win, point& pos) noexcept -> bool
+{
+	// the events are read by the pump, ask for the cursor instead
+	pos = get_position(win);
+	return true;
+}
+
 inline void set_position(const point& pos, const window& win) noexcept
 {
 	glfwSetCursorPos(to_win_impl(win).get_impl(), static_cast<double>(pos.x), static_cast<double>(pos.y));
@@ -102,7 +109,7 @@ inline void set_position(const point& pos) noexcept
 	if(focused_win)
 	{
         auto window_pos = focused_win->get_position();
-		glfwSetCursorPos(focused_win->get_impl(), static_cast<double>(pos.x - window_pos.x), static_cast<double>(pos.y - window_pos.x));
+		glfwSetCursorPos(focused_win->get_impl(), static_cast<double>(pos.x - window_pos.x), static_cast<double>(pos.y - window_pos.y));
 	}
 }
 
@@ -119,6 +126,11 @@ inline void disable(bool enabled)
 		focused_win->grab_input(enabled);
 	}
 }
+
+inline auto set_raw_motion_enabled(bool /*enabled*/) noexcept -> bool
+{
+	return false;
+}
 }
 }
 }
@@ -493,8 +493,43 @@ public:
 		glfwSetWindowIcon(impl_.get(), 1, &image);
 	}
 
+	//-----------------------------------------------------------------------------
+	/// Stores the cursor position reported by a motion event and returns the
+	/// motion relative to the previously reported one.
+	//-----------------------------------------------------------------------------
+	auto update_cursor_position(const pointf& pos) noexcept -> pointf
+	{
+		pointf rel{};
+		if(has_cursor_pos_)
+		{
+			rel.x = pos.x - cursor_pos_.x;
+			rel.y = pos.y - cursor_pos_.y;
+		}
+		cursor_pos_ = pos;
+		has_cursor_pos_ = true;
+		return rel;
+	}
+
+	//-----------------------------------------------------------------------------
+	/// The cursor position of the last motion event, asks GLFW before the first.
+	//-----------------------------------------------------------------------------
+	auto get_cursor_position() const noexcept -> pointf
+	{
+		if(has_cursor_pos_)
+		{
+			return cursor_pos_;
+		}
+
+		double x{};
+		double y{};
+		glfwGetCursorPos(impl_.get(), &x, &y);
+		return {static_cast<float>(x), static_cast<float>(y)};
+	}
+
 private:
 	uint32_t id_{};
+	pointf cursor_pos_{};
+	bool has_cursor_pos_{};
 	area min_size_{};
 	area max_size_{};
 	point pos_before_fullscreen_{};
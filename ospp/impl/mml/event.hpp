@@ -1,15 +1,15 @@
 #pragma once
 #include "../../event.h"
+#include "../../event_arena.hpp"
+#include "../../event_dispatch.hpp"
 
 #include "keyboard.hpp"
 #include "mouse.hpp"
 #include "window.hpp"
 
 #include <algorithm>
-#include <codecvt>
+#include <chrono>
 #include <cstring>
-#include <deque>
-#include <locale>
 namespace os
 {
 namespace detail
@@ -17,6 +17,52 @@ namespace detail
 namespace mml
 {
 
+//-----------------------------------------------------------------------------
+/// The os::events value to_event produces for a native event type, used to
+/// drop masked out events before converting them.
+//-----------------------------------------------------------------------------
+inline auto to_event_type(::mml::platform_event::event_type type) noexcept -> events
+{
+	switch(type)
+	{
+		case ::mml::platform_event::closed:
+		case ::mml::platform_event::resized:
+		case ::mml::platform_event::moved:
+		case ::mml::platform_event::lost_focus:
+		case ::mml::platform_event::gained_focus:
+		case ::mml::platform_event::mouse_entered:
+		case ::mml::platform_event::mouse_left:
+			return events::window;
+		case ::mml::platform_event::key_pressed:
+			return events::key_down;
+		case ::mml::platform_event::key_released:
+			return events::key_up;
+		case ::mml::platform_event::text_entered:
+			return events::text_input;
+		case ::mml::platform_event::mouse_button_pressed:
+		case ::mml::platform_event::mouse_button_released:
+			return events::mouse_button;
+		case ::mml::platform_event::mouse_moved:
+			return events::mouse_motion;
+		case ::mml::platform_event::mouse_moved_raw:
+			return events::mouse_motion_raw;
+		case ::mml::platform_event::mouse_wheel_scrolled:
+			return events::mouse_wheel;
+		case ::mml::platform_event::joystick_connected:
+			return events::joystic_added;
+		case ::mml::platform_event::joystick_disconnected:
+			return events::joystic_removed;
+		case ::mml::platform_event::touch_began:
+			return events::finger_down;
+		case ::mml::platform_event::touch_ended:
+			return events::finger_up;
+		case ::mml::platform_event::touch_moved:
+			return events::finger_motion;
+		default:
+			return events::unknown;
+	}
+}
+
 inline auto to_event(const ::mml::platform_event& e, uint32_t window_id) -> event
 {
 	event ev{};
@@ -69,6 +115,7 @@ inline auto to_event(const ::mml::platform_event& e, uint32_t window_id) -> even
 			ev.key.ctrl = e.key.control;
 			ev.key.shift = e.key.shift;
 			ev.key.system = e.key.system;
+			ev.key.repeat = e.key.repeat;
 			break;
 		case ::mml::platform_event::key_released:
 			ev.type = events::key_up;
@@ -86,7 +133,7 @@ inline auto to_event(const ::mml::platform_event& e, uint32_t window_id) -> even
 
 			ev.type = events::text_input;
 			ev.text.window_id = window_id;
-			ev.text.text = std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>{}.to_bytes(e.text.unicode);
+			ev.text.text = get_event_arena().store_utf8(e.text.unicode);
 			break;
 		case ::mml::platform_event::mouse_button_pressed:
 			ev.type = events::mouse_button;
@@ -116,6 +163,12 @@ inline auto to_event(const ::mml::platform_event& e, uint32_t window_id) -> even
 			ev.motion.raw_x = e.mouse_move.x;
 			ev.motion.raw_y = e.mouse_move.y;
 			break;
+		case ::mml::platform_event::mouse_moved_raw:
+			ev.type = events::mouse_motion_raw;
+			ev.motion_raw.window_id = window_id;
+			ev.motion_raw.dx = e.mouse_move_raw.delta_x;
+			ev.motion_raw.dy = e.mouse_move_raw.delta_y;
+			break;
 		case ::mml::platform_event::mouse_wheel_scrolled:
 			ev.type = events::mouse_wheel;
 			ev.wheel.window_id = window_id;
@@ -155,23 +208,133 @@ inline auto to_event(const ::mml::platform_event& e, uint32_t window_id) -> even
 	return ev;
 }
 
+inline auto now() noexcept -> uint64_t
+{
+	using namespace std::chrono;
+	return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+//-----------------------------------------------------------------------------
+/// Maps native event times (32 bit X server milliseconds) onto now(). The
+/// offset between both clocks is the smallest one seen so far, which is the
+/// one of the event delivered with the least delay, so a mapped time never
+/// lies in the future.
+//-----------------------------------------------------------------------------
+class native_time_mapper
+{
+public:
+	auto to_timestamp(uint32_t time_ms, uint64_t current) noexcept -> uint64_t
+	{
+		if(time_ms == 0)
+		{
+			return current;
+		}
+
+		// the server time wraps around every ~49.7 days
+		if(time_ms < last_ms_ && last_ms_ - time_ms > 0x80000000u)
+		{
+			wraps_ += uint64_t(1) << 32;
+		}
+		last_ms_ = time_ms;
+
+		const uint64_t native = (wraps_ + time_ms) * 1000000;
+		const auto offset = static_cast<int64_t>(current - native);
+		if(!has_offset_ || offset < offset_)
+		{
+			offset_ = offset;
+			has_offset_ = true;
+		}
+		return native + static_cast<uint64_t>(offset_);
+	}
+
+private:
+	uint64_t wraps_{};
+	uint32_t last_ms_{};
+	int64_t offset_{};
+	bool has_offset_{};
+};
+
+//-----------------------------------------------------------------------------
+/// The pump checks the mask itself, nothing to configure.
+//-----------------------------------------------------------------------------
+inline void apply_event_mask(event_mask) noexcept
+{
+}
+
+//-----------------------------------------------------------------------------
+/// Translates a native event of \a window and dispatches it.
+//-----------------------------------------------------------------------------
+inline void process_native_event(window_impl& window, const ::mml::platform_event& ev) noexcept
+{
+	if(ev.type == ::mml::platform_event::closed)
+	{
+		window.set_recieved_close_event(true);
+	}
+
+	const auto type = to_event_type(ev.type);
+	if(!is_event_enabled(type))
+	{
+		if(type == events::mouse_motion)
+		{
+			// keep tracking so xrel stays correct once enabled
+			window.update_cursor_position({float(ev.mouse_move.x), float(ev.mouse_move.y)});
+		}
+		return;
+	}
+
+	static native_time_mapper time_mapper;
+	auto e = to_event(ev, window.get_id());
+	e.timestamp = time_mapper.to_timestamp(ev.time, now());
+	if(e.type == events::mouse_motion)
+	{
+		auto rel = window.update_cursor_position({e.motion.x, e.motion.y});
+		e.motion.xrel = rel.x;
+		e.motion.yrel = rel.y;
+	}
+
+	dispatch_event(e);
+}
+
+//-----------------------------------------------------------------------------
+/// Set as the mml window's event callback, so native events are translated
+/// straight into the ospp queue instead of going through mml's own queue.
+//-----------------------------------------------------------------------------
+inline void on_native_event(const ::mml::platform_event& ev, void* user)
+{
+	process_native_event(*static_cast<window_impl*>(user), ev);
+}
+
 inline void pump_events() noexcept
 {
+	std::lock_guard<std::recursive_mutex> lock(get_windows_mutex());
 	auto& windows = get_windows();
-	for(auto& window : windows)
+
+	// Event watches may create or destroy windows while we iterate, walk a
+	// copy and skip the windows destroyed meanwhile. Kept around so the
+	// pump doesn't allocate.
+	static thread_local std::vector<window_impl*> snapshot;
+	snapshot.assign(std::begin(windows), std::end(windows));
+	for(auto window : snapshot)
 	{
+		if(std::find(std::begin(windows), std::end(windows), window) == std::end(windows))
+		{
+			continue;
+		}
+
 		auto& win_impl = window->get_impl();
+		if(!window->has_native_event_callback())
+		{
+			win_impl.set_event_callback(&on_native_event, window);
+			window->set_has_native_event_callback(true);
+		}
 
+		// Only events mml queued before the callback was set come out
+		// here. Polling makes mml read the OS, which hands everything new
+		// to on_native_event, so this is a single pass.
 		::mml::platform_event ev{};
-		if(win_impl.poll_event(ev))
+		while(win_impl.poll_event(ev))
 		{
-			if(ev.type == ::mml::platform_event::closed)
-			{
-				window->set_recieved_close_event(true);
-			}
-			auto e = to_event(ev, window->get_id());
-
-			push_event(std::move(e));
+			process_native_event(*window, ev);
 		}
 	}
 
@@ -184,12 +347,64 @@ inline void pump_events() noexcept
 		{
 			reported = true;
 
-			event ev{};
-			ev.type = events::quit;
-			push_event(std::move(ev));
+			if(is_event_enabled(events::quit))
+			{
+				event ev{};
+				ev.type = events::quit;
+				dispatch_event(ev);
+			}
 		}
 	}
 }
+
+inline void wait_events(int32_t timeout_ms) noexcept
+{
+#if !defined(__linux__)
+	// Joysticks can't wake up the native wait, keep polling them.
+	constexpr int32_t joystick_poll_interval_ms = 10;
+	for(unsigned int i = 0; i < ::mml::joystick::count; ++i)
+	{
+		if(::mml::joystick::is_connected(i))
+		{
+			if(timeout_ms < 0 || timeout_ms > joystick_poll_interval_ms)
+			{
+				timeout_ms = joystick_poll_interval_ms;
+			}
+			break;
+		}
+	}
+#endif
+
+	::mml::window::wait_for_events(timeout_ms);
+}
+
+inline void wake_up() noexcept
+{
+	::mml::window::wake_up();
+}
+
+//-----------------------------------------------------------------------------
+/// On Windows, messages are only delivered to the thread which created the
+/// window, an input thread would never see any.
+//-----------------------------------------------------------------------------
+inline auto can_pump_from_any_thread() noexcept -> bool
+{
+#if defined(_WIN32)
+	return false;
+#else
+	return true;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/// No limit: events that Xlib calls made by other threads (e.g. the renderer
+/// swapping buffers) read into Xlib's queue wake the wait up through the same
+/// eventfd as wake_up.
+//-----------------------------------------------------------------------------
+inline auto max_input_thread_wait_ms() noexcept -> int32_t
+{
+	return -1;
+}
 } // namespace mml
 } // namespace detail
 } // namespace os
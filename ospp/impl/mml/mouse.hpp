@@ -76,6 +76,19 @@ inline auto get_position(const window& relative_to) noexcept -> point
 	return result;
 }
 
+inline auto latch_position(const window& relative_to, point& pos) noexcept -> bool
+{
+	std::array<std::int32_t, 2> latched{};
+	if(!::mml::mouse::latch_position(to_win_impl(relative_to).get_impl(), latched))
+	{
+		return false;
+	}
+
+	pos.x = latched[0];
+	pos.y = latched[1];
+	return true;
+}
+
 inline void set_position(const point& pos) noexcept
 {
 	::mml::mouse::set_position({{pos.x, pos.y}});
@@ -95,6 +108,17 @@ inline void disable(bool /*val*/)
 {
 
 }
+
+inline auto set_raw_motion_enabled(bool enabled) noexcept -> bool
+{
+	if(!::mml::mouse::is_raw_motion_available())
+	{
+		return false;
+	}
+
+	::mml::mouse::set_raw_motion_enabled(enabled);
+	return true;
+}
 } // namespace mml
 } // namespace detail
 } // namespace mouse
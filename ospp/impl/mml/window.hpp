@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace os
@@ -84,9 +85,21 @@ inline auto get_windows() noexcept -> std::vector<window_impl*>&
 	return windows;
 }
 
+//-----------------------------------------------------------------------------
+/// Guards the window list, which the input thread walks while windows are
+/// created and destroyed elsewhere. Recursive since event watches run
+/// during the pump.
+//-----------------------------------------------------------------------------
+inline auto get_windows_mutex() noexcept -> std::recursive_mutex&
+{
+	static std::recursive_mutex mutex;
+	return mutex;
+}
+
 inline auto register_window(window_impl* window) -> uint32_t
 {
 	static uint32_t id{0};
+	std::lock_guard<std::recursive_mutex> lock(get_windows_mutex());
 	auto& windows = get_windows();
 	windows.emplace_back(window);
 	return ++id;
@@ -94,6 +107,7 @@ inline auto register_window(window_impl* window) -> uint32_t
 
 inline void unregister_window(uint32_t id)
 {
+	std::lock_guard<std::recursive_mutex> lock(get_windows_mutex());
 	auto& windows = get_windows();
 	windows.erase(std::remove_if(std::begin(windows), std::end(windows),
 								 [id](const auto& win) { return win->get_id() == id; }),
@@ -124,7 +138,12 @@ public:
 
 	~window_impl()
 	{
+		// The input thread dispatches under the windows mutex, passing this
+		// window to on_native_event. Keep it locked until the mml window,
+		// which runs that callback, is gone.
+		std::lock_guard<std::recursive_mutex> lock(get_windows_mutex());
 		unregister_window(id_);
+		impl_.dispose();
 	}
 
 	static auto get_current_video_driver() -> const char*
@@ -330,6 +349,15 @@ public:
 		return recieved_close_event_;
 	}
 
+	void set_has_native_event_callback(bool b) noexcept
+	{
+		has_native_event_callback_ = b;
+	}
+	auto has_native_event_callback() const noexcept -> bool
+	{
+		return has_native_event_callback_;
+	}
+
 	void set_cursor(const cursor& c) noexcept
 	{
 		impl_.set_mouse_cursor(to_cursor_impl(c).get_impl());
@@ -352,6 +380,7 @@ public:
 
 	static auto is_any_focused() noexcept -> bool
 	{
+		std::lock_guard<std::recursive_mutex> lock(get_windows_mutex());
 		for(auto& window : get_windows())
 		{
 			if(window->has_focus())
@@ -362,6 +391,23 @@ public:
 		return false;
 	}
 
+	//-----------------------------------------------------------------------------
+	/// Stores the cursor position reported by a motion event and returns the
+	/// motion relative to the previously reported one.
+	//-----------------------------------------------------------------------------
+	auto update_cursor_position(const pointf& pos) noexcept -> pointf
+	{
+		pointf rel{};
+		if(has_cursor_pos_)
+		{
+			rel.x = pos.x - cursor_pos_.x;
+			rel.y = pos.y - cursor_pos_.y;
+		}
+		cursor_pos_ = pos;
+		has_cursor_pos_ = true;
+		return rel;
+	}
+
 private:
 	::mml::window impl_;
 	std::string title_{};
@@ -371,6 +417,9 @@ private:
 	float opacity_{1.0f};
 	bool grabbed_{false};
 	bool recieved_close_event_{false};
+	bool has_native_event_callback_{false};
+	pointf cursor_pos_{};
+	bool has_cursor_pos_{false};
 };
 } // namespace mml
 } // namespace detail
@@ -1,12 +1,13 @@
 #pragma once
 
 #include "../../event.h"
+#include "../../event_arena.hpp"
+#include "../../event_dispatch.hpp"
 
 #include "keyboard.hpp"
 #include "mouse.hpp"
 
 #include <cstring>
-#include <deque>
 
 namespace os
 {
@@ -56,21 +57,15 @@ void fill_drop_event(event& ev, const SDL_Event& e)
 	ev.drop.window_id = e.drop.windowID;
 	ev.drop.x = e.drop.x;
 	ev.drop.y = e.drop.y;
-	if(e.drop.source != nullptr)
-	{
-		ev.drop.source = e.drop.source;
-	}
-	if(e.drop.data != nullptr)
-	{
-		ev.drop.data = e.drop.data;
-	}
+	auto& arena = get_event_arena();
+	ev.drop.source = arena.store(e.drop.source);
+	ev.drop.data = arena.store(e.drop.data);
 }
 
 inline auto to_event(const SDL_Event& e) -> event
 {
-
-
 	event ev{};
+	ev.timestamp = e.common.timestamp;
 	switch(e.type)
 	{
 		case SDL_EVENT_QUIT:
@@ -117,6 +112,7 @@ inline auto to_event(const SDL_Event& e) -> event
 			ev.key.ctrl = (e.key.mod & SDL_KMOD_CTRL) != 0;
 			ev.key.shift = (e.key.mod & SDL_KMOD_SHIFT) != 0;
 			ev.key.system = (e.key.mod & SDL_KMOD_GUI) != 0;
+			ev.key.repeat = e.key.repeat;
 			break;
 		case SDL_EVENT_KEY_UP:
 			ev.type = events::key_up;
@@ -130,7 +126,7 @@ inline auto to_event(const SDL_Event& e) -> event
 		case SDL_EVENT_TEXT_INPUT:
 			ev.type = events::text_input;
 			ev.text.window_id = e.text.windowID;
-			ev.text.text = e.text.text;
+			ev.text.text = get_event_arena().store(e.text.text);
 			break;
 		case SDL_EVENT_MOUSE_BUTTON_DOWN:
 			ev.type = events::mouse_button;
@@ -156,21 +152,22 @@ inline auto to_event(const SDL_Event& e) -> event
 			ev.type = events::mouse_motion;
 			ev.motion.window_id = e.motion.windowID;
 
-			ev.motion.x = int32_t(e.motion.x);
-			ev.motion.y = int32_t(e.motion.y);
+			ev.motion.x = e.motion.x;
+			ev.motion.y = e.motion.y;
 
-			if (SDL_GetWindowRelativeMouseMode(SDL_GetWindowFromID(e.motion.windowID)))
+			if(e.motion.windowID != 0 && e.motion.windowID == mouse::detail::sdl::relative_window_id())
 			{
 				auto& pos = mouse::detail::sdl::mouse_pos_while_relative();
 				pos.x += e.motion.xrel;
 				pos.y += e.motion.yrel;
-				ev.motion.x = int32_t(pos.x);
-				ev.motion.y = int32_t(pos.y);
-
+				ev.motion.x = pos.x;
+				ev.motion.y = pos.y;
 			}
 
-			ev.motion.raw_x = int32_t(ev.motion.x);
-			ev.motion.raw_y = int32_t(ev.motion.y);
+			ev.motion.raw_x = ev.motion.x;
+			ev.motion.raw_y = ev.motion.y;
+			ev.motion.xrel = e.motion.xrel;
+			ev.motion.yrel = e.motion.yrel;
 
 			break;
 		case SDL_EVENT_MOUSE_WHEEL:
@@ -248,15 +245,133 @@ inline auto to_event(const SDL_Event& e) -> event
 	return ev;
 }
 
+struct event_type_range
+{
+	events type;
+	uint32_t first;
+	uint32_t last;
+};
+
+//-----------------------------------------------------------------------------
+/// Native event types converted to each os::events value by to_event.
+//-----------------------------------------------------------------------------
+constexpr event_type_range event_type_ranges[] = {
+	{events::quit, SDL_EVENT_QUIT, SDL_EVENT_QUIT},
+	{events::app_terminating, SDL_EVENT_TERMINATING, SDL_EVENT_TERMINATING},
+	{events::app_low_memory, SDL_EVENT_LOW_MEMORY, SDL_EVENT_LOW_MEMORY},
+	{events::app_will_enter_background, SDL_EVENT_WILL_ENTER_BACKGROUND, SDL_EVENT_WILL_ENTER_BACKGROUND},
+	{events::app_did_enter_background, SDL_EVENT_DID_ENTER_BACKGROUND, SDL_EVENT_DID_ENTER_BACKGROUND},
+	{events::app_will_enter_foreground, SDL_EVENT_WILL_ENTER_FOREGROUND, SDL_EVENT_WILL_ENTER_FOREGROUND},
+	{events::app_did_enter_foreground, SDL_EVENT_DID_ENTER_FOREGROUND, SDL_EVENT_DID_ENTER_FOREGROUND},
+	{events::display_orientation, SDL_EVENT_DISPLAY_ORIENTATION, SDL_EVENT_DISPLAY_ORIENTATION},
+	{events::display_connected, SDL_EVENT_DISPLAY_ADDED, SDL_EVENT_DISPLAY_ADDED},
+	{events::display_disconnected, SDL_EVENT_DISPLAY_REMOVED, SDL_EVENT_DISPLAY_REMOVED},
+	{events::display_moved, SDL_EVENT_DISPLAY_MOVED, SDL_EVENT_DISPLAY_MOVED},
+	{events::display_content_scale_changed, SDL_EVENT_DISPLAY_CONTENT_SCALE_CHANGED,
+	 SDL_EVENT_DISPLAY_CONTENT_SCALE_CHANGED},
+	{events::window, SDL_EVENT_WINDOW_FIRST, SDL_EVENT_WINDOW_LAST},
+	{events::key_down, SDL_EVENT_KEY_DOWN, SDL_EVENT_KEY_DOWN},
+	{events::key_up, SDL_EVENT_KEY_UP, SDL_EVENT_KEY_UP},
+	{events::text_input, SDL_EVENT_TEXT_INPUT, SDL_EVENT_TEXT_INPUT},
+	{events::mouse_button, SDL_EVENT_MOUSE_BUTTON_DOWN, SDL_EVENT_MOUSE_BUTTON_DOWN},
+	{events::mouse_button, SDL_EVENT_MOUSE_BUTTON_UP, SDL_EVENT_MOUSE_BUTTON_UP},
+	{events::mouse_motion, SDL_EVENT_MOUSE_MOTION, SDL_EVENT_MOUSE_MOTION},
+	{events::mouse_wheel, SDL_EVENT_MOUSE_WHEEL, SDL_EVENT_MOUSE_WHEEL},
+	{events::finger_down, SDL_EVENT_FINGER_DOWN, SDL_EVENT_FINGER_DOWN},
+	{events::finger_up, SDL_EVENT_FINGER_UP, SDL_EVENT_FINGER_UP},
+	{events::finger_motion, SDL_EVENT_FINGER_MOTION, SDL_EVENT_FINGER_MOTION},
+	{events::clipboard_update, SDL_EVENT_CLIPBOARD_UPDATE, SDL_EVENT_CLIPBOARD_UPDATE},
+	{events::drop_file, SDL_EVENT_DROP_FILE, SDL_EVENT_DROP_FILE},
+	{events::drop_text, SDL_EVENT_DROP_TEXT, SDL_EVENT_DROP_TEXT},
+	{events::drop_begin, SDL_EVENT_DROP_BEGIN, SDL_EVENT_DROP_BEGIN},
+	{events::drop_complete, SDL_EVENT_DROP_COMPLETE, SDL_EVENT_DROP_COMPLETE},
+	{events::drop_position, SDL_EVENT_DROP_POSITION, SDL_EVENT_DROP_POSITION},
+	{events::gamepad_added, SDL_EVENT_GAMEPAD_ADDED, SDL_EVENT_GAMEPAD_ADDED},
+	{events::gamepad_removed, SDL_EVENT_GAMEPAD_REMOVED, SDL_EVENT_GAMEPAD_REMOVED},
+	{events::joystic_added, SDL_EVENT_JOYSTICK_ADDED, SDL_EVENT_JOYSTICK_ADDED},
+	{events::joystic_removed, SDL_EVENT_JOYSTICK_REMOVED, SDL_EVENT_JOYSTICK_REMOVED},
+};
+
+//-----------------------------------------------------------------------------
+/// Stops SDL from generating masked out event types at all.
+//-----------------------------------------------------------------------------
+inline void apply_event_mask(event_mask mask) noexcept
+{
+	for(const auto& range : event_type_ranges)
+	{
+		const bool enabled = (mask & event_bit(range.type)) != 0;
+		for(uint32_t type = range.first; type <= range.last; ++type)
+		{
+			SDL_SetEventEnabled(type, enabled);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+/// User event type pushed by wake_up to interrupt wait_events. Zero if SDL
+/// ran out of user event types.
+//-----------------------------------------------------------------------------
+inline auto get_wake_up_event_type() noexcept -> uint32_t
+{
+	static const uint32_t type = SDL_RegisterEvents(1);
+	return type;
+}
+
 inline void pump_events() noexcept
 {
+	const auto wake_up_type = get_wake_up_event_type();
+
 	SDL_Event ev{};
 	while(SDL_PollEvent(&ev) != 0)
 	{
+		if(wake_up_type != 0 && ev.type == wake_up_type)
+		{
+			continue;
+		}
 		auto e = to_event(ev);
-		push_event(std::move(e));
+		if(is_event_enabled(e.type))
+		{
+			dispatch_event(e);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+/// SDL event timestamps are in this time base already.
+//-----------------------------------------------------------------------------
+inline auto now() noexcept -> uint64_t
+{
+	return SDL_GetTicksNS();
+}
+
+inline void wait_events(int32_t timeout_ms) noexcept
+{
+	SDL_WaitEventTimeout(nullptr, timeout_ms < 0 ? -1 : timeout_ms);
+}
+
+inline void wake_up() noexcept
+{
+	const auto wake_up_type = get_wake_up_event_type();
+	if(wake_up_type != 0)
+	{
+		SDL_Event ev{};
+		ev.type = wake_up_type;
+		SDL_PushEvent(&ev);
 	}
 }
+
+//-----------------------------------------------------------------------------
+/// SDL video events must be pumped on the thread that initialized video.
+//-----------------------------------------------------------------------------
+inline auto can_pump_from_any_thread() noexcept -> bool
+{
+	return false;
+}
+
+inline auto max_input_thread_wait_ms() noexcept -> int32_t
+{
+	return -1;
+}
 } // namespace sdl
 } // namespace detail
 } // namespace os
@@ -91,6 +91,13 @@ inline point get_position(const window& relative_to) noexcept
 	return get_position_impl(to_win_impl(relative_to).get_impl());
 }
 
+inline auto latch_position(const window& relative_to, point& pos) noexcept -> bool
+{
+	// the events are read by the pump, ask for the cursor instead
+	pos = get_position(relative_to);
+	return true;
+}
+
 inline void set_position(const point& pos) noexcept
 {
 	SDL_WarpMouseGlobal(float(pos.x), float(pos.y));
@@ -101,12 +108,22 @@ inline void set_position(const point& pos, const window& relative_to) noexcept
 	set_position_impl(pos, to_win_impl(relative_to).get_impl());
 }
 
-inline auto mouse_pos_while_relative() -> point&
+inline auto mouse_pos_while_relative() -> pointf&
 {
-	static point p{};
+	static pointf p{};
 	return p;
 }
 
+//-----------------------------------------------------------------------------
+/// Id of the window disable() put in relative mode, 0 if none. Lets motion
+/// events skip asking SDL for the window and its mode.
+//-----------------------------------------------------------------------------
+inline auto relative_window_id() -> SDL_WindowID&
+{
+	static SDL_WindowID id{};
+	return id;
+}
+
 
 inline auto mouse_pos_on_relative_start() -> point&
 {
@@ -129,14 +146,15 @@ inline void disable(bool val) noexcept
 		// Grab the input, confining the cursor to the window
 		SDL_SetWindowMouseGrab(window, val);
 
-		static bool relative = SDL_GetWindowRelativeMouseMode(window);
+		const auto id = SDL_GetWindowID(window);
+		const bool relative = relative_window_id() == id;
 
 		bool is_different = relative != val;
 
 		if(val && is_different)
 		{
 			auto mouse_window_pos = get_position_impl(window);
-			mouse_pos_while_relative() = mouse_window_pos;
+			mouse_pos_while_relative() = pointf(float(mouse_window_pos.x), float(mouse_window_pos.y));
 			mouse_pos_on_relative_start() = mouse_window_pos;
 		}
 
@@ -145,13 +163,26 @@ inline void disable(bool val) noexcept
 			set_position_impl(mouse_pos_on_relative_start(), window);
 		}
 
-		relative = val;
+		if(val)
+		{
+			relative_window_id() = id;
+		}
+		else if(relative)
+		{
+			relative_window_id() = 0;
+		}
 	}
 
 	// Set relative mouse mode
 	SDL_SetWindowRelativeMouseMode(window, val);
 }
 
+inline auto set_raw_motion_enabled(bool /*enabled*/) noexcept -> bool
+{
+	// relative mode (disable) is the closest SDL has, its motion still goes
+	// through mouse_motion
+	return false;
+}
 
 } // namespace sdl
 } // namespace detail
@@ -1,4 +1,8 @@
 #include "keyboard.h"
+#include "event.h"
+#include "event_dispatch.hpp"
+
+#include <atomic>
 
 #if defined(SDL_BACKEND)
 #include "impl/sdl/keyboard.hpp"
@@ -17,6 +21,65 @@
 
 namespace os
 {
+namespace
+{
+//-----------------------------------------------------------------------------
+/// Written by the pumping thread only, so the down mask needs no CAS. The
+/// consumer takes the pressed and released masks with an exchange.
+//-----------------------------------------------------------------------------
+struct key_state_tracker
+{
+	std::atomic<uint64_t> down[key::state::word_count]{};
+	std::atomic<uint64_t> pressed[key::state::word_count]{};
+	std::atomic<uint64_t> released[key::state::word_count]{};
+};
+
+auto get_key_state_tracker() noexcept -> key_state_tracker&
+{
+	static key_state_tracker tracker;
+	return tracker;
+}
+} // namespace
+
+namespace detail
+{
+void track_key_state(const event& e) noexcept
+{
+	auto& tracker = get_key_state_tracker();
+	if(e.type == events::key_down || e.type == events::key_up)
+	{
+		const auto index = static_cast<size_t>(e.key.code);
+		if(index >= static_cast<size_t>(key::count))
+		{
+			return;
+		}
+
+		const auto word = index / 64;
+		const auto bit = uint64_t(1) << (index % 64);
+		const auto was_down = (tracker.down[word].load(std::memory_order_relaxed) & bit) != 0;
+		if(e.type == events::key_down && !was_down)
+		{
+			tracker.down[word].fetch_or(bit, std::memory_order_relaxed);
+			tracker.pressed[word].fetch_or(bit, std::memory_order_relaxed);
+		}
+		else if(e.type == events::key_up && was_down)
+		{
+			tracker.down[word].fetch_and(~bit, std::memory_order_relaxed);
+			tracker.released[word].fetch_or(bit, std::memory_order_relaxed);
+		}
+	}
+	else if(e.type == events::window && e.window.type == window_event_id::focus_lost)
+	{
+		// not every backend sends the key_up of keys held while losing the focus
+		for(size_t i = 0; i < key::state::word_count; ++i)
+		{
+			const auto held = tracker.down[i].exchange(0, std::memory_order_relaxed);
+			tracker.released[i].fetch_or(held, std::memory_order_relaxed);
+		}
+	}
+}
+} // namespace detail
+
 namespace key
 {
 auto from_string(const std::string& str) noexcept -> code
@@ -33,6 +96,24 @@ auto is_pressed(os::key::code key_code) noexcept -> bool
 {
 	return impl::key::is_pressed(key_code);
 }
+
+auto get_state() noexcept -> state
+{
+	auto& tracker = get_key_state_tracker();
+
+	// most words don't change in a frame, only pay for the exchange when they did
+	auto take = [](std::atomic<uint64_t>& mask)
+	{ return mask.load(std::memory_order_relaxed) != 0 ? mask.exchange(0, std::memory_order_relaxed) : 0; };
+
+	state result;
+	for(size_t i = 0; i < state::word_count; ++i)
+	{
+		result.down_mask[i] = tracker.down[i].load(std::memory_order_relaxed);
+		result.pressed_mask[i] = take(tracker.pressed[i]);
+		result.released_mask[i] = take(tracker.released[i]);
+	}
+	return result;
+}
 } // namespace key
 
 auto has_screen_keyboard() noexcept -> bool
@@ -259,6 +259,50 @@ auto from_string(const std::string& str) noexcept -> code;
 auto to_string(os::key::code key_code) noexcept -> std::string;
 
 auto is_pressed(os::key::code key_code) noexcept -> bool;
+
+//-----------------------------------------------------------------------------
+/// Snapshot of the keyboard built from the key_down and key_up events seen
+/// by the pump, so reading it never talks to the backend. The pressed and
+/// released masks hold the keys which changed since the previous snapshot.
+//-----------------------------------------------------------------------------
+struct state
+{
+	static constexpr size_t word_count = (static_cast<size_t>(count) + 63) / 64;
+
+	uint64_t down_mask[word_count]{};
+	uint64_t pressed_mask[word_count]{};
+	uint64_t released_mask[word_count]{};
+
+	auto is_down(code key_code) const noexcept -> bool
+	{
+		return test(down_mask, key_code);
+	}
+
+	auto is_just_pressed(code key_code) const noexcept -> bool
+	{
+		return test(pressed_mask, key_code);
+	}
+
+	auto is_just_released(code key_code) const noexcept -> bool
+	{
+		return test(released_mask, key_code);
+	}
+
+private:
+	static auto test(const uint64_t* mask, code key_code) noexcept -> bool
+	{
+		const auto index = static_cast<size_t>(key_code);
+		return index < static_cast<size_t>(count) && ((mask[index / 64] >> (index % 64)) & 1) != 0;
+	}
+};
+
+//-----------------------------------------------------------------------------
+/// Returns the current keyboard state and starts a new frame: keys pressed
+/// or released from now on show up in the next snapshot. Meant to be called
+/// once per frame, after polling the events. Needs key_down and key_up to be
+/// enabled in the event mask.
+//-----------------------------------------------------------------------------
+auto get_state() noexcept -> state;
 } // namespace key
 
 auto has_screen_keyboard() noexcept -> bool;
@@ -1,4 +1,9 @@
 #include "mouse.h"
+#include "event.h"
+#include "event_dispatch.hpp"
+#include "window.h"
+
+#include <mutex>
 
 #if defined(SDL_BACKEND)
 #include "impl/sdl/mouse.hpp"
@@ -17,10 +22,215 @@
 
 namespace os
 {
+namespace
+{
+struct raw_motion_accumulator
+{
+	std::mutex mutex;
+	pointf sum{};
+};
+
+auto get_raw_motion_accumulator() noexcept -> raw_motion_accumulator&
+{
+	static raw_motion_accumulator accumulator;
+	return accumulator;
+}
+
+//-----------------------------------------------------------------------------
+/// What the events told about the pointer in one window: the last position
+/// and a ring of the last motion_history_size motion samples. Positions are
+/// only comparable within a window, the moved events carry the frame's
+/// corner, not the client area's.
+//-----------------------------------------------------------------------------
+struct pointer_window
+{
+	uint32_t window_id{};
+	bool used{};
+	bool has_position{};
+	uint64_t last_used{};
+	pointf position{};
+	size_t count{}; // samples ever written
+	mouse::motion_sample samples[mouse::motion_history_size]{};
+};
+
+//-----------------------------------------------------------------------------
+/// The windows the pointer was seen in lately. Allocated once, a window
+/// without a slot takes the least recently used one.
+//-----------------------------------------------------------------------------
+struct pointer_table
+{
+	static constexpr size_t max_windows = 8;
+
+	auto find(uint32_t window_id) noexcept -> pointer_window*
+	{
+		for(auto& entry : windows)
+		{
+			if(entry.used && entry.window_id == window_id)
+			{
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
+
+	auto acquire(uint32_t window_id) noexcept -> pointer_window&
+	{
+		auto entry = last != nullptr && last->window_id == window_id ? last : find(window_id);
+		if(entry == nullptr)
+		{
+			entry = &windows[0];
+			for(auto& candidate : windows)
+			{
+				if(!candidate.used)
+				{
+					entry = &candidate;
+					break;
+				}
+				if(candidate.last_used < entry->last_used)
+				{
+					entry = &candidate;
+				}
+			}
+			if(entry == hovered)
+			{
+				hovered = nullptr;
+			}
+			*entry = {};
+			entry->window_id = window_id;
+			entry->used = true;
+		}
+		entry->last_used = ++use_count;
+		last = entry;
+		return *entry;
+	}
+
+	std::mutex mutex;
+	pointer_window windows[max_windows];
+	pointer_window* last{};
+	pointer_window* hovered{}; // the window the pointer is in, if known
+	uint64_t use_count{};
+	// buttons pressed in our windows, one bit per mouse::button
+	uint32_t buttons{};
+};
+
+auto get_pointer_table() noexcept -> pointer_table&
+{
+	static pointer_table table;
+	return table;
+}
+
+auto to_bit(mouse::button b) noexcept -> uint32_t
+{
+	return uint32_t(1) << static_cast<uint32_t>(b);
+}
+
+//-----------------------------------------------------------------------------
+/// The cache only follows the pointer while the events feeding it flow. The
+/// window events tell when the pointer leaves our windows.
+//-----------------------------------------------------------------------------
+auto is_position_cached() noexcept -> bool
+{
+	return is_event_enabled(events::mouse_motion) && is_event_enabled(events::window);
+}
+
+auto are_buttons_cached() noexcept -> bool
+{
+	return is_event_enabled(events::mouse_button) && is_event_enabled(events::window);
+}
+} // namespace
+
+namespace detail
+{
+void track_mouse_state(const event& e) noexcept
+{
+	auto& table = get_pointer_table();
+	switch(e.type)
+	{
+		case events::mouse_motion:
+		{
+			std::lock_guard<std::mutex> lock(table.mutex);
+			auto& entry = table.acquire(e.motion.window_id);
+			auto& sample = entry.samples[entry.count++ % mouse::motion_history_size];
+			sample.timestamp = e.timestamp;
+			sample.x = e.motion.x;
+			sample.y = e.motion.y;
+			entry.position = {e.motion.x, e.motion.y};
+			entry.has_position = true;
+			table.hovered = &entry;
+			break;
+		}
+		case events::mouse_button:
+		{
+			std::lock_guard<std::mutex> lock(table.mutex);
+			if(e.button.state_id == state::pressed)
+			{
+				table.buttons |= to_bit(e.button.button);
+			}
+			else
+			{
+				table.buttons &= ~to_bit(e.button.button);
+			}
+
+			auto& entry = table.acquire(e.button.window_id);
+			entry.position = {float(e.button.x), float(e.button.y)};
+			entry.has_position = true;
+			table.hovered = &entry;
+			break;
+		}
+		case events::mouse_motion_raw:
+		{
+			auto& accumulator = get_raw_motion_accumulator();
+			std::lock_guard<std::mutex> lock(accumulator.mutex);
+			accumulator.sum.x += e.motion_raw.dx;
+			accumulator.sum.y += e.motion_raw.dy;
+			break;
+		}
+		case events::window:
+		{
+			if(e.window.type == window_event_id::focus_lost)
+			{
+				// a release may never come, as for keys
+				std::lock_guard<std::mutex> lock(table.mutex);
+				table.buttons = 0;
+			}
+			else if(e.window.type == window_event_id::enter)
+			{
+				// the position is unknown until the next motion
+				std::lock_guard<std::mutex> lock(table.mutex);
+				auto& entry = table.acquire(e.window.window_id);
+				entry.has_position = false;
+				table.hovered = &entry;
+			}
+			else if(e.window.type == window_event_id::leave)
+			{
+				std::lock_guard<std::mutex> lock(table.mutex);
+				if(table.hovered != nullptr && table.hovered->window_id == e.window.window_id)
+				{
+					table.hovered = nullptr;
+				}
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+} // namespace detail
+
 namespace mouse
 {
 auto is_button_pressed(button b) noexcept -> bool
 {
+	if(are_buttons_cached())
+	{
+		// presses outside of our windows never reach us
+		auto& table = get_pointer_table();
+		std::lock_guard<std::mutex> lock(table.mutex);
+		if(table.hovered != nullptr)
+		{
+			return (table.buttons & to_bit(b)) != 0;
+		}
+	}
 	return impl::is_button_pressed(b);
 }
 
@@ -30,10 +240,40 @@ auto get_position() noexcept -> point
 }
 
 auto get_position(const window& relative_to) noexcept -> point
+{
+	if(is_position_cached())
+	{
+		auto& table = get_pointer_table();
+		std::lock_guard<std::mutex> lock(table.mutex);
+		const auto hovered = table.hovered;
+		if(hovered != nullptr && hovered->has_position && hovered->window_id == relative_to.get_id())
+		{
+			return {int32_t(hovered->position.x), int32_t(hovered->position.y)};
+		}
+	}
+	return impl::get_position(relative_to);
+}
+
+auto query_exact() noexcept -> point
+{
+	return impl::get_position();
+}
+
+auto query_exact(const window& relative_to) noexcept -> point
 {
 	return impl::get_position(relative_to);
 }
 
+auto latch_position(const window& win) noexcept -> point
+{
+	point pos{};
+	if(impl::latch_position(win, pos))
+	{
+		return pos;
+	}
+	return get_position(win);
+}
+
 void set_position(const point& pos) noexcept
 {
 	impl::set_position(pos);
@@ -54,6 +294,43 @@ void disable(bool val)
 	impl::disable(val);
 }
 
+auto set_raw_motion_enabled(bool enabled) noexcept -> bool
+{
+	return impl::set_raw_motion_enabled(enabled);
+}
+
+auto take_raw_motion() noexcept -> pointf
+{
+	auto& accumulator = get_raw_motion_accumulator();
+	std::lock_guard<std::mutex> lock(accumulator.mutex);
+	const auto result = accumulator.sum;
+	accumulator.sum = {};
+	return result;
+}
+
+auto get_motion_history(const window& win, uint64_t since_timestamp, motion_sample* out, size_t capacity) noexcept
+	-> size_t
+{
+	auto& table = get_pointer_table();
+	std::lock_guard<std::mutex> lock(table.mutex);
+	const auto history = table.find(win.get_id());
+	if(history == nullptr || out == nullptr)
+	{
+		return 0;
+	}
+
+	const auto kept = history->count < motion_history_size ? history->count : motion_history_size;
+	size_t written = 0;
+	for(auto i = history->count - kept; i < history->count && written < capacity; ++i)
+	{
+		const auto& sample = history->samples[i % motion_history_size];
+		if(sample.timestamp > since_timestamp)
+		{
+			out[written++] = sample;
+		}
+	}
+	return written;
+}
 
 } // namespace mouse
 } // namespace os
@@ -19,15 +19,89 @@ enum class button : uint8_t
 	button_count ///< Keep last -- the total number of mouse buttons
 };
 
+//-----------------------------------------------------------------------------
+/// Answered from the mouse_button events, without asking the backend, while
+/// those and the window events are enabled and the pointer is in one of the
+/// application's windows. Asks the backend otherwise, since presses outside
+/// of the windows never arrive as events.
+//-----------------------------------------------------------------------------
 auto is_button_pressed(button b) noexcept -> bool;
 
+//-----------------------------------------------------------------------------
+/// The position in screen coordinates, always from the backend. The events
+/// only tell where a window's frame is, not where its client area starts.
+//-----------------------------------------------------------------------------
 auto get_position() noexcept -> point;
+
+//-----------------------------------------------------------------------------
+/// The position of the last mouse_motion or mouse_button event, while those
+/// and the window events are enabled and the pointer is in \a relative_to.
+/// Asks the backend when it is elsewhere or the position isn't known yet.
+//-----------------------------------------------------------------------------
 auto get_position(const window& relative_to) noexcept -> point;
 
+//-----------------------------------------------------------------------------
+/// Always asks the backend, a round trip to the display server on X11. For
+/// when the pointer may have moved without the events being pumped.
+//-----------------------------------------------------------------------------
+auto query_exact() noexcept -> point;
+auto query_exact(const window& relative_to) noexcept -> point;
+
+//-----------------------------------------------------------------------------
+/// The freshest pointer position relative to \a win, for drawing a cursor
+/// right before submitting a frame. Looks at the motion the backend received
+/// but nothing pumped yet, without blocking or translating any event, and
+/// falls back to get_position when there is none. SDL and GLFW keep no such
+/// queue to look at, they ask for the cursor position directly. On MML on
+/// Windows, must be called from the thread which created the window.
+//-----------------------------------------------------------------------------
+auto latch_position(const window& win) noexcept -> point;
+
 void set_position(const point& pos) noexcept;
 void set_position(const point& pos, const window& relative_to) noexcept;
 
 void capture(bool enabled);
 void disable(bool val);
+
+//-----------------------------------------------------------------------------
+/// Opts in to mouse_motion_raw events: the motion reported by the device,
+/// without pointer acceleration and not stopped by the screen edges.
+/// Returns false when the backend has no raw input, currently all but MML
+/// on X11 with XInput2.
+//-----------------------------------------------------------------------------
+auto set_raw_motion_enabled(bool enabled) noexcept -> bool;
+
+//-----------------------------------------------------------------------------
+/// Sum of the raw motion pumped since the previous call, for code which
+/// wants one delta per frame rather than each mouse_motion_raw event.
+/// Safe to call from any thread.
+//-----------------------------------------------------------------------------
+auto take_raw_motion() noexcept -> pointf;
+
+//-----------------------------------------------------------------------------
+/// A pointer position seen by the pump, relative to the window.
+//-----------------------------------------------------------------------------
+struct motion_sample
+{
+	uint64_t timestamp{}; ///< event::timestamp of the mouse_motion event
+	float x{};
+	float y{};
+};
+
+//-----------------------------------------------------------------------------
+/// Number of samples kept per window, older ones are overwritten.
+//-----------------------------------------------------------------------------
+constexpr size_t motion_history_size = 512;
+
+//-----------------------------------------------------------------------------
+/// Copies the samples of \a win newer than \a since_timestamp to \a out,
+/// oldest first, and returns how many were written. Every mouse_motion event
+/// of the backend is kept, even the ones merged by event coalescing, so
+/// passing the timestamp of the last returned sample as \a since_timestamp
+/// walks the whole stroke. Needs the mouse_motion events to be enabled.
+/// Safe to call from any thread.
+//-----------------------------------------------------------------------------
+auto get_motion_history(const window& win, uint64_t since_timestamp, motion_sample* out, size_t capacity) noexcept
+	-> size_t;
 } // namespace mouse
 } // namespace os
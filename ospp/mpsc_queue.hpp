@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace os
+{
+namespace detail
+{
+//-----------------------------------------------------------------------------
+/// Bounded, lock-free, multi-producer / single-consumer queue.
+/// All slots are preallocated, so pushing and popping never touch the heap.
+/// Every slot carries a sequence number telling whether it is free for the
+/// producer of a given lap or ready for the consumer. Producers claim a
+/// position with a CAS on the tail, fill the slot and publish it by bumping
+/// its sequence. The single consumer owns the head.
+///
+/// A published slot can be briefly locked, either by the consumer while it
+/// copies it out or by a producer merging a newer element into the last one
+/// (see try_merge_last). A locked slot looks not-ready to everyone else.
+//-----------------------------------------------------------------------------
+template <typename T, size_t Capacity>
+class mpsc_queue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+	mpsc_queue() noexcept
+	{
+		for(size_t i = 0; i < Capacity; ++i)
+		{
+			sequences_[i].store(i, std::memory_order_relaxed);
+		}
+	}
+
+	mpsc_queue(const mpsc_queue&) = delete;
+	mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+	//-----------------------------------------------------------------------------
+	/// Can be called from any thread. Returns false if the queue is full.
+	//-----------------------------------------------------------------------------
+	template <typename U>
+	auto try_push(U&& value) noexcept -> bool
+	{
+		size_t pos = 0;
+		return try_push(std::forward<U>(value), pos);
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Same as above, \a pos receives the position of the pushed element.
+	/// It is popped once popped() is past it.
+	//-----------------------------------------------------------------------------
+	template <typename U>
+	auto try_push(U&& value, size_t& pos) noexcept -> bool
+	{
+		pos = tail_.load(std::memory_order_relaxed);
+		for(;;)
+		{
+			const size_t seq = sequences_[pos & mask].load(std::memory_order_acquire);
+			const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+			if(diff == 0)
+			{
+				if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if(diff < 0)
+			{
+				// the slot still holds an element from the previous lap
+				return false;
+			}
+			else
+			{
+				pos = tail_.load(std::memory_order_relaxed);
+			}
+		}
+
+		slots_[pos & mask] = std::forward<U>(value);
+		sequences_[pos & mask].store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Can be called from any thread. Locks the most recently pushed element
+	/// if the consumer has not started reading it yet and lets \a merge update
+	/// it in place. \a merge returns false to leave it untouched, in which
+	/// case the caller should push normally.
+	//-----------------------------------------------------------------------------
+	template <typename Merge>
+	auto try_merge_last(Merge&& merge) noexcept -> bool
+	{
+		const size_t tail = tail_.load(std::memory_order_acquire);
+		if(tail == 0)
+		{
+			return false;
+		}
+
+		const size_t last = tail - 1;
+		if(!try_lock(last))
+		{
+			return false;
+		}
+
+		// Only merge into the tail, never across an element pushed meanwhile.
+		const bool merged = tail_.load(std::memory_order_relaxed) == tail && merge(slots_[last & mask]);
+		sequences_[last & mask].store(last + 1, std::memory_order_release);
+		return merged;
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Must only be called from the consumer thread.
+	//-----------------------------------------------------------------------------
+	auto try_pop(T& value) noexcept -> bool
+	{
+		const size_t pos = head_;
+		if(!try_lock(pos))
+		{
+			return false;
+		}
+
+		value = std::move(slots_[pos & mask]);
+		sequences_[pos & mask].store(pos + Capacity, std::memory_order_release);
+		head_ = pos + 1;
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Must only be called from the consumer thread. Pops up to \a max ready
+	/// elements into \a out with at most two contiguous copies (one when the
+	/// run does not wrap around the end of the ring).
+	//-----------------------------------------------------------------------------
+	auto try_pop_bulk(T* out, size_t max) noexcept -> size_t
+	{
+		const size_t pos = head_;
+		size_t count = 0;
+		while(count < max && try_lock(pos + count))
+		{
+			++count;
+		}
+
+		if(count == 0)
+		{
+			return 0;
+		}
+
+		const size_t first = pos & mask;
+		const size_t first_count = std::min(count, Capacity - first);
+		auto slots = slots_.data();
+		std::move(slots + first, slots + first + first_count, out);
+		std::move(slots, slots + (count - first_count), out + first_count);
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			sequences_[(pos + i) & mask].store(pos + i + Capacity, std::memory_order_release);
+		}
+		head_ = pos + count;
+		return count;
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Consumer side only. Positions claimed by producers but not yet
+	/// published count as queued.
+	//-----------------------------------------------------------------------------
+	auto empty() const noexcept -> bool
+	{
+		return tail_.load(std::memory_order_acquire) == head_;
+	}
+
+	auto size() const noexcept -> size_t
+	{
+		const size_t tail = tail_.load(std::memory_order_acquire);
+		return tail - head_;
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Can be called from any thread. Number of positions claimed so far.
+	//-----------------------------------------------------------------------------
+	auto pushed() const noexcept -> size_t
+	{
+		return tail_.load(std::memory_order_acquire);
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Consumer side only. Number of elements popped so far.
+	//-----------------------------------------------------------------------------
+	auto popped() const noexcept -> size_t
+	{
+		return head_;
+	}
+
+	static constexpr auto capacity() noexcept -> size_t
+	{
+		return Capacity;
+	}
+
+private:
+	static constexpr size_t mask = Capacity - 1;
+	static constexpr size_t locked = ~size_t(0);
+
+	auto try_lock(size_t pos) noexcept -> bool
+	{
+		size_t expected = pos + 1;
+		return sequences_[pos & mask].compare_exchange_strong(expected, locked, std::memory_order_acquire,
+															  std::memory_order_relaxed);
+	}
+
+	static constexpr size_t cache_line = 64;
+
+	std::array<T, Capacity> slots_{};
+	std::array<std::atomic<size_t>, Capacity> sequences_;
+	alignas(cache_line) std::atomic<size_t> tail_{0};
+	alignas(cache_line) size_t head_{0};
+};
+} // namespace detail
+} // namespace os
@@ -6,4 +6,5 @@
 #include "init.h"
 #include "keyboard.h"
 #include "mouse.h"
+#include "recording.h"
 #include "window.h"
@@ -0,0 +1,547 @@
+#include "recording.h"
+#include "event.h"
+#include "event_arena.hpp"
+#include "event_dispatch.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace os
+{
+namespace
+{
+// A recording is a file_header followed by one record per event. A record
+// is a record_header, the raw event and the event's payload strings, each
+// followed by a null terminator, padded to a multiple of 8 bytes.
+// Raw events tie a recording to the build that made it, which is what
+// event_size guards.
+constexpr char recording_magic[8] = {'O', 'S', 'P', 'P', 'R', 'E', 'C', '\0'};
+constexpr uint32_t recording_version = 2;
+constexpr size_t record_alignment = 8;
+constexpr size_t flush_threshold = 64 * 1024;
+
+struct file_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t event_size;
+};
+
+struct record_header
+{
+	uint32_t payload_size;
+	uint32_t reserved;
+};
+
+auto padded(size_t size) noexcept -> size_t
+{
+	return (size + record_alignment - 1) & ~(record_alignment - 1);
+}
+
+//-----------------------------------------------------------------------------
+/// Buffers records in memory and appends them to the file in large writes,
+/// so recording an event usually costs a couple of memcpy on the pump.
+//-----------------------------------------------------------------------------
+class recorder
+{
+public:
+	~recorder()
+	{
+		close();
+	}
+
+	auto open(const std::string& path) noexcept -> bool
+	{
+		close();
+
+		file_ = std::fopen(path.c_str(), "wb");
+		if(file_ == nullptr)
+		{
+			return false;
+		}
+
+		file_header header{};
+		std::memcpy(header.magic, recording_magic, sizeof(header.magic));
+		header.version = recording_version;
+		header.event_size = sizeof(event);
+
+		buffer_.reserve(flush_threshold + 4096);
+		append(&header, sizeof(header));
+		open_.store(true, std::memory_order_release);
+		return true;
+	}
+
+	void close() noexcept
+	{
+		open_.store(false, std::memory_order_release);
+		if(file_ != nullptr)
+		{
+			flush();
+			std::fclose(file_);
+			file_ = nullptr;
+		}
+		buffer_.clear();
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Lock free, so the pump can skip the lock while nothing is recorded.
+	//-----------------------------------------------------------------------------
+	auto is_open() const noexcept -> bool
+	{
+		return open_.load(std::memory_order_acquire);
+	}
+
+	auto get_mutex() noexcept -> std::mutex&
+	{
+		return mutex_;
+	}
+
+	void write(const event& e) noexcept
+	{
+		size_t payload_size = 0;
+		detail::for_each_payload(e,
+								 [&payload_size](const text_view& view) { payload_size += view.size + 1; });
+
+		record_header header{};
+		header.payload_size = static_cast<uint32_t>(padded(payload_size));
+		append(&header, sizeof(header));
+
+		// pointers are meaningless in the file, keep it deterministic
+		event stored = e;
+		detail::for_each_payload(stored, [](text_view& view) { view.data = nullptr; });
+		append(&stored, sizeof(stored));
+
+		detail::for_each_payload(e,
+								 [this](const text_view& view)
+								 {
+									 append(view.data != nullptr ? view.data : "", view.size);
+									 buffer_.push_back('\0');
+								 });
+		buffer_.resize(buffer_.size() + (header.payload_size - payload_size), '\0');
+
+		if(buffer_.size() >= flush_threshold)
+		{
+			flush();
+		}
+	}
+
+private:
+	void append(const void* data, size_t size)
+	{
+		auto bytes = static_cast<const char*>(data);
+		buffer_.insert(buffer_.end(), bytes, bytes + size);
+	}
+
+	void flush() noexcept
+	{
+		if(!buffer_.empty())
+		{
+			std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+			buffer_.clear();
+		}
+	}
+
+	std::mutex mutex_;
+	std::atomic<bool> open_{false};
+	std::FILE* file_{};
+	std::vector<char> buffer_;
+};
+
+//-----------------------------------------------------------------------------
+/// Read-only memory mapping of a whole file.
+//-----------------------------------------------------------------------------
+class mapped_file
+{
+public:
+	~mapped_file()
+	{
+		close();
+	}
+
+	auto open(const std::string& path) noexcept -> bool
+	{
+		close();
+
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if(file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size{};
+		HANDLE mapping = nullptr;
+		if(GetFileSizeEx(file, &size) && size.QuadPart > 0)
+		{
+			mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		}
+		if(mapping != nullptr)
+		{
+			data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			size_ = data_ != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+			// the view keeps the mapping alive
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+#else
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd < 0)
+		{
+			return false;
+		}
+
+		struct stat info{};
+		if(fstat(fd, &info) == 0 && info.st_size > 0)
+		{
+			void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if(data != MAP_FAILED)
+			{
+				madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+				data_ = static_cast<const char*>(data);
+				size_ = static_cast<size_t>(info.st_size);
+			}
+		}
+		// the mapping keeps the file alive
+		::close(fd);
+#endif
+		return data_ != nullptr;
+	}
+
+	void close() noexcept
+	{
+		if(data_ != nullptr)
+		{
+#if defined(_WIN32)
+			UnmapViewOfFile(data_);
+#else
+			munmap(const_cast<char*>(data_), size_);
+#endif
+		}
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	auto data() const noexcept -> const char*
+	{
+		return data_;
+	}
+
+	auto size() const noexcept -> size_t
+	{
+		return size_;
+	}
+
+private:
+	const char* data_{};
+	size_t size_{};
+};
+
+//-----------------------------------------------------------------------------
+/// Walks the records of a mapped recording. Payloads are copied into the
+/// event arena, so injected events don't depend on the mapping.
+//-----------------------------------------------------------------------------
+class replayer
+{
+public:
+	auto open(const std::string& path, replay_mode mode) noexcept -> bool
+	{
+		close();
+
+		if(!file_.open(path))
+		{
+			return false;
+		}
+
+		file_header header{};
+		if(file_.size() < sizeof(header))
+		{
+			close();
+			return false;
+		}
+
+		std::memcpy(&header, file_.data(), sizeof(header));
+		if(std::memcmp(header.magic, recording_magic, sizeof(header.magic)) != 0 ||
+		   header.version != recording_version || header.event_size != sizeof(event))
+		{
+			close();
+			return false;
+		}
+
+		mode_ = mode;
+		offset_ = sizeof(header);
+		has_start_ = false;
+		open_.store(true, std::memory_order_release);
+		return true;
+	}
+
+	void close() noexcept
+	{
+		open_.store(false, std::memory_order_release);
+		file_.close();
+		offset_ = 0;
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Lock free, dispatch_event checks it for every translated event.
+	//-----------------------------------------------------------------------------
+	auto is_open() const noexcept -> bool
+	{
+		return open_.load(std::memory_order_acquire);
+	}
+
+	//-----------------------------------------------------------------------------
+	/// Recursive because the watches run while the replay injects, and they
+	/// may stop it.
+	//-----------------------------------------------------------------------------
+	auto get_mutex() noexcept -> std::recursive_mutex&
+	{
+		return mutex_;
+	}
+
+	void replay(size_t max) noexcept
+	{
+		const auto current = now();
+
+		event e{};
+		size_t next = 0;
+		for(; max > 0 && read(e, next); --max)
+		{
+			if(!has_start_)
+			{
+				first_timestamp_ = e.timestamp;
+				start_ = current;
+				has_start_ = true;
+			}
+
+			const auto due = to_replay_time(e.timestamp);
+			if(mode_ == replay_mode::realtime && due > current)
+			{
+				break;
+			}
+
+			auto payload = file_.data() + offset_ + sizeof(record_header) + sizeof(event);
+			detail::for_each_payload(e,
+									 [&payload](text_view& view)
+									 {
+										 const auto size = view.size;
+										 view = detail::get_event_arena().store(payload, size);
+										 payload += size + 1;
+									 });
+
+			e.timestamp = due;
+			offset_ = next;
+
+			if(is_event_enabled(e.type))
+			{
+				detail::inject_event(e);
+			}
+
+			// a watch stopped or restarted the replay
+			if(file_.data() == nullptr || offset_ != next)
+			{
+				return;
+			}
+		}
+
+		if(!read(e, next))
+		{
+			close();
+		}
+	}
+
+	auto get_wait_budget() const noexcept -> int32_t
+	{
+		if(!is_open())
+		{
+			return -1;
+		}
+
+		event e{};
+		size_t next = 0;
+		if(mode_ == replay_mode::as_fast_as_possible || !has_start_ || !read(e, next))
+		{
+			return 0;
+		}
+
+		const auto due = to_replay_time(e.timestamp);
+		const auto current = now();
+		if(due <= current)
+		{
+			return 0;
+		}
+		return static_cast<int32_t>((due - current + 999999) / 1000000);
+	}
+
+private:
+	//-----------------------------------------------------------------------------
+	/// Reads the event of the record at the current offset. Fails at the end
+	/// of the file and on a truncated or corrupt record, which ends the replay.
+	//-----------------------------------------------------------------------------
+	auto read(event& e, size_t& next) const noexcept -> bool
+	{
+		const auto size = file_.size();
+		if(offset_ + sizeof(record_header) + sizeof(event) > size)
+		{
+			return false;
+		}
+
+		record_header header{};
+		std::memcpy(&header, file_.data() + offset_, sizeof(header));
+		next = offset_ + sizeof(header) + sizeof(event) + header.payload_size;
+		if(next > size)
+		{
+			return false;
+		}
+
+		std::memcpy(&e, file_.data() + offset_ + sizeof(header), sizeof(event));
+
+		// the payloads are copied with the sizes stored in the event, which
+		// must fit in the record, itself checked to fit in the mapping above
+		size_t payload_size = 0;
+		bool valid = true;
+		detail::for_each_payload(e,
+								 [&](const text_view& view)
+								 {
+									 valid = valid && view.size < header.payload_size - payload_size;
+									 if(valid)
+									 {
+										 payload_size += view.size + 1;
+									 }
+								 });
+		return valid;
+	}
+
+	auto to_replay_time(uint64_t timestamp) const noexcept -> uint64_t
+	{
+		return start_ + (timestamp > first_timestamp_ ? timestamp - first_timestamp_ : 0);
+	}
+
+	std::recursive_mutex mutex_;
+	std::atomic<bool> open_{false};
+	mapped_file file_;
+	replay_mode mode_{};
+	size_t offset_{};
+	uint64_t first_timestamp_{};
+	uint64_t start_{};
+	bool has_start_{};
+};
+
+auto get_recorder() noexcept -> recorder&
+{
+	static recorder instance;
+	return instance;
+}
+
+auto get_replayer() noexcept -> replayer&
+{
+	static replayer instance;
+	return instance;
+}
+} // namespace
+
+namespace detail
+{
+void record_event(const event& e) noexcept
+{
+	auto& recorder = get_recorder();
+	if(!recorder.is_open())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(recorder.get_mutex());
+	if(recorder.is_open())
+	{
+		recorder.write(e);
+	}
+}
+
+void replay_events(size_t max) noexcept
+{
+	auto& replayer = get_replayer();
+	if(!replayer.is_open())
+	{
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(replayer.get_mutex());
+	if(replayer.is_open())
+	{
+		replayer.replay(max);
+	}
+}
+
+auto get_replay_wait_budget() noexcept -> int32_t
+{
+	auto& replayer = get_replayer();
+	if(!replayer.is_open())
+	{
+		return -1;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(replayer.get_mutex());
+	return replayer.get_wait_budget();
+}
+} // namespace detail
+
+auto start_event_recording(const std::string& path) noexcept -> bool
+{
+	auto& recorder = get_recorder();
+	std::lock_guard<std::mutex> lock(recorder.get_mutex());
+	return recorder.open(path);
+}
+
+void stop_event_recording() noexcept
+{
+	auto& recorder = get_recorder();
+	std::lock_guard<std::mutex> lock(recorder.get_mutex());
+	recorder.close();
+}
+
+auto is_event_recording() noexcept -> bool
+{
+	return get_recorder().is_open();
+}
+
+auto start_event_replay(const std::string& path, replay_mode mode) noexcept -> bool
+{
+	auto& replayer = get_replayer();
+	std::lock_guard<std::recursive_mutex> lock(replayer.get_mutex());
+	if(!replayer.open(path, mode))
+	{
+		return false;
+	}
+
+	// the pumping thread may be sleeping without a timeout
+	detail::wake_pump();
+	return true;
+}
+
+void stop_event_replay() noexcept
+{
+	auto& replayer = get_replayer();
+	std::lock_guard<std::recursive_mutex> lock(replayer.get_mutex());
+	replayer.close();
+}
+
+auto is_event_replaying() noexcept -> bool
+{
+	return get_replayer().is_open();
+}
+} // namespace os
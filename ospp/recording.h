@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace os
+{
+//-----------------------------------------------------------------------------
+/// Appends every event translated by the backend, payloads included, to a
+/// binary file at \a path. Events are recorded before the event watches run,
+/// so consumed events are part of the recording too. Returns false if the
+/// file can't be created. Can be called from any thread, including while
+/// the input thread pumps; the recording covers the pumps that follow.
+//-----------------------------------------------------------------------------
+auto start_event_recording(const std::string& path) noexcept -> bool;
+void stop_event_recording() noexcept;
+auto is_event_recording() noexcept -> bool;
+
+enum class replay_mode : uint8_t
+{
+	/// Events are injected on their original timeline.
+	realtime,
+	/// Every pump injects as many events as the queue can take.
+	as_fast_as_possible
+};
+
+//-----------------------------------------------------------------------------
+/// Memory maps a file written by start_event_recording and injects its
+/// events through the pump, where they go through the event mask and the
+/// watches like translated events. Input coming from the backend is ignored
+/// until the replay ends. Timestamps are shifted to the replay's start.
+/// Returns false if the file is missing or was recorded by an incompatible
+/// build. Can be called from any thread, including while the input thread
+/// pumps, and from an event watch.
+//-----------------------------------------------------------------------------
+auto start_event_replay(const std::string& path, replay_mode mode = replay_mode::realtime) noexcept -> bool;
+void stop_event_replay() noexcept;
+auto is_event_replaying() noexcept -> bool;
+} // namespace os
@@ -1,5 +1,7 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 namespace os
@@ -33,8 +35,33 @@ struct area2d
 };
 
 using point = vec2d<int32_t>;
+using pointf = vec2d<float>;
 using area = area2d<uint32_t>;
 
+//-----------------------------------------------------------------------------
+/// Non-owning, null terminated utf8 string.
+//-----------------------------------------------------------------------------
+struct text_view
+{
+	const char* data{};
+	size_t size{};
+
+	auto empty() const noexcept -> bool
+	{
+		return size == 0;
+	}
+
+	auto c_str() const noexcept -> const char*
+	{
+		return data ? data : "";
+	}
+
+	auto to_string() const -> std::string
+	{
+		return {c_str(), size};
+	}
+};
+
 struct image
 {
 	std::vector<uint8_t> pixels;
@@ -1,5 +1,8 @@
+#include "unit/unit.hpp"
+
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <ospp/os.h>
 
@@ -133,8 +136,30 @@ static os::image load_cursor_image(const char* image[])
 	return parse_image(data, mask, 32, 32);
 }
 
-int main()
+// Exit code ctest treats as skipped
+static const int skipped = 77;
+
+static int run_unit_tests()
+{
+	if(!os::init())
+	{
+		std::cout << "os::init failed, skipping" << std::endl;
+		return skipped;
+	}
+
+	const auto failed = unit::run_tests();
+	os::shutdown();
+	return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
 {
+	// ctest runs the unit tests, without arguments this is an interactive demo
+	if(argc > 1 && std::strcmp(argv[1], "--unit") == 0)
+	{
+		return run_unit_tests();
+	}
+
 	os::init();
 
 	{
@@ -0,0 +1,146 @@
+#include "unit.hpp"
+
+#include <ospp/event.h>
+#include <ospp/mpsc_queue.hpp>
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::array<os::event, 64> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+void push_motion(uint32_t window_id, float x, float xrel)
+{
+	os::event e{};
+	e.type = os::events::mouse_motion;
+	e.motion.window_id = window_id;
+	e.motion.x = x;
+	e.motion.xrel = xrel;
+	os::push_event(e);
+}
+
+void push_window(uint32_t window_id, os::window_event_id type, int32_t data1, int32_t data2)
+{
+	os::event e{};
+	e.type = os::events::window;
+	e.window.window_id = window_id;
+	e.window.type = type;
+	e.window.data1 = data1;
+	e.window.data2 = data2;
+	os::push_event(e);
+}
+} // namespace
+
+UNIT_TEST(coalescing_merges_motion_of_the_same_window)
+{
+	discard_pending();
+	os::set_event_coalescing(true);
+	push_motion(1, 1.0f, 1.0f);
+	push_motion(1, 3.0f, 2.0f);
+	push_motion(2, 5.0f, 1.0f);
+	push_motion(1, 6.0f, 3.0f);
+	os::set_event_coalescing(false);
+
+	// only consecutive motion of a window merges, the relative motion adds up
+	const size_t count = os::poll_events(buffer.data(), buffer.size());
+	UNIT_CHECK(count == 3);
+	UNIT_CHECK(buffer[0].motion.window_id == 1 && buffer[0].motion.x == 3.0f && buffer[0].motion.xrel == 3.0f);
+	UNIT_CHECK(buffer[1].motion.window_id == 2 && buffer[1].motion.x == 5.0f);
+	UNIT_CHECK(buffer[2].motion.window_id == 1 && buffer[2].motion.x == 6.0f && buffer[2].motion.xrel == 3.0f);
+}
+
+UNIT_TEST(coalescing_merges_moved_and_resized_separately)
+{
+	discard_pending();
+	os::set_event_coalescing(true);
+	push_window(1, os::window_event_id::moved, 10, 10);
+	push_window(1, os::window_event_id::moved, 20, 30);
+	push_window(1, os::window_event_id::resized, 100, 100);
+	push_window(1, os::window_event_id::resized, 200, 150);
+	push_window(2, os::window_event_id::resized, 50, 50);
+	push_window(1, os::window_event_id::shown, 0, 0);
+	push_window(1, os::window_event_id::shown, 0, 0);
+	os::set_event_coalescing(false);
+
+	const size_t count = os::poll_events(buffer.data(), buffer.size());
+	UNIT_CHECK(count == 5);
+	UNIT_CHECK(buffer[0].window.type == os::window_event_id::moved && buffer[0].window.data1 == 20 &&
+			   buffer[0].window.data2 == 30);
+	UNIT_CHECK(buffer[1].window.type == os::window_event_id::resized && buffer[1].window.data1 == 200 &&
+			   buffer[1].window.data2 == 150);
+	UNIT_CHECK(buffer[2].window.window_id == 2);
+	UNIT_CHECK(buffer[3].window.type == os::window_event_id::shown);
+	UNIT_CHECK(buffer[4].window.type == os::window_event_id::shown);
+}
+
+UNIT_TEST(coalescing_is_off_by_default)
+{
+	discard_pending();
+	UNIT_CHECK(!os::is_event_coalescing_enabled());
+	push_motion(1, 1.0f, 1.0f);
+	push_motion(1, 2.0f, 1.0f);
+	UNIT_CHECK(os::poll_events(buffer.data(), buffer.size()) == 2);
+}
+
+UNIT_TEST(mpsc_queue_merge_races_with_pop)
+{
+	// Every producer either merges one into the newest element or pushes a
+	// new one. A merge into an element the consumer is already copying out
+	// would lose it, so the popped values must add up to all contributions.
+	// The merge dawdles before writing to give the consumer time to race it.
+	constexpr int producers = 2;
+	constexpr int per_producer = 100000;
+	static os::detail::mpsc_queue<int, 8> queue;
+
+	std::vector<std::thread> threads;
+	for(int p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([]() {
+			for(int i = 0; i < per_producer; ++i)
+			{
+				while(!queue.try_merge_last([](int& last) {
+					for(volatile int spin = 0; spin < 256; ++spin)
+					{
+					}
+					++last;
+					return true;
+				}) && !queue.try_push(1))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::atomic<bool> done(false);
+	std::thread joiner([&threads, &done]() {
+		for(auto& thread : threads)
+		{
+			thread.join();
+		}
+		done = true;
+	});
+
+	long long total = 0;
+	int value = 0;
+	while(!done.load() || !queue.empty())
+	{
+		if(queue.try_pop(value))
+		{
+			total += value;
+		}
+	}
+	joiner.join();
+
+	UNIT_CHECK(total == static_cast<long long>(producers) * per_producer);
+}
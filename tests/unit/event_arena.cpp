@@ -0,0 +1,81 @@
+#include "unit.hpp"
+
+#include <ospp/event.h>
+#include <ospp/event_arena.hpp>
+#include <ospp/event_dispatch.hpp>
+
+#include <array>
+#include <cstring>
+#include <string>
+
+// Payloads are stored the way a backend stores them while it pumps: in the
+// arena, then handed to dispatch_event. The test thread is the pumping one.
+
+namespace
+{
+void discard_pending()
+{
+	std::array<os::event, 64> buffer{};
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+void dispatch_text(const char* text)
+{
+	os::event e{};
+	e.type = os::events::text_input;
+	e.text.text = os::detail::get_event_arena().store(text);
+	os::detail::dispatch_event(e);
+}
+
+auto has_text(const os::event& e, const char* text) -> bool
+{
+	return e.type == os::events::text_input && e.text.text.size == std::strlen(text) &&
+		   std::strcmp(e.text.text.c_str(), text) == 0;
+}
+} // namespace
+
+UNIT_TEST(event_arena_payload_survives_until_next_poll)
+{
+	discard_pending();
+	dispatch_text("first");
+	dispatch_text("second");
+
+	// the pump of the second poll must keep the payload still queued
+	os::event first{};
+	os::event second{};
+	UNIT_CHECK(os::poll_events(&first, 1) == 1);
+	UNIT_CHECK(has_text(first, "first"));
+	UNIT_CHECK(os::poll_events(&second, 1) == 1);
+	UNIT_CHECK(has_text(second, "second"));
+
+	// once everything was popped and released the arena starts over
+	const auto* reused = first.text.text.data;
+	discard_pending();
+	dispatch_text("third");
+	os::event third{};
+	UNIT_CHECK(os::poll_events(&third, 1) == 1);
+	UNIT_CHECK(has_text(third, "third"));
+	UNIT_CHECK(third.text.text.data == reused);
+	discard_pending();
+}
+
+UNIT_TEST(event_arena_stores_null_terminated_copies)
+{
+	os::detail::event_arena arena;
+	const char source[] = "payload";
+	const auto view = arena.store(source, 3);
+	UNIT_CHECK(view.size == 3);
+	UNIT_CHECK(view.data != source);
+	UNIT_CHECK(std::strcmp(view.c_str(), "pay") == 0);
+	UNIT_CHECK(arena.store(nullptr).empty());
+
+	// larger than a chunk
+	const std::string big(os::detail::event_arena::chunk_size * 2, 'x');
+	const auto big_view = arena.store(big.data(), big.size());
+	UNIT_CHECK(big_view.to_string() == big);
+	UNIT_CHECK(view.to_string() == "pay");
+
+	UNIT_CHECK(arena.store_utf8(0x20AC).to_string() == "\xE2\x82\xAC");
+}
@@ -0,0 +1,77 @@
+#include "unit.hpp"
+
+#include <ospp/event.h>
+#include <ospp/event_dispatch.hpp>
+#include <ospp/recording.h>
+
+#include <array>
+#include <cstdio>
+
+namespace
+{
+constexpr const char* path = "ospp_unit_event_mask.bin";
+
+std::array<os::event, 64> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+void dispatch(os::events type)
+{
+	os::event e{};
+	e.type = type;
+	os::detail::dispatch_event(e);
+}
+} // namespace
+
+UNIT_TEST(event_mask_enables_every_type_by_default)
+{
+	UNIT_CHECK(os::get_event_mask() == os::all_events);
+	UNIT_CHECK(os::is_event_enabled(os::events::mouse_motion));
+	UNIT_CHECK(os::is_event_enabled(os::events::key_down));
+}
+
+UNIT_TEST(event_mask_disables_types_missing_from_it)
+{
+	const auto mask = os::all_events & ~os::event_bit(os::events::mouse_motion);
+	os::set_event_mask(mask);
+	UNIT_CHECK(os::get_event_mask() == mask);
+	UNIT_CHECK(!os::is_event_enabled(os::events::mouse_motion));
+	UNIT_CHECK(os::is_event_enabled(os::events::mouse_button));
+	UNIT_CHECK(os::is_event_enabled(os::events::key_down));
+
+	os::set_event_mask(os::all_events);
+	UNIT_CHECK(os::is_event_enabled(os::events::mouse_motion));
+}
+
+UNIT_TEST(event_mask_filters_replayed_events)
+{
+	discard_pending();
+	UNIT_CHECK(os::start_event_recording(path));
+	dispatch(os::events::mouse_motion);
+	dispatch(os::events::key_down);
+	dispatch(os::events::mouse_motion);
+	dispatch(os::events::key_up);
+	os::stop_event_recording();
+	discard_pending();
+
+	// the recording holds every type, the mask applies when replaying it
+	os::set_event_mask(os::all_events & ~os::event_bit(os::events::mouse_motion));
+	UNIT_CHECK(os::start_event_replay(path, os::replay_mode::as_fast_as_possible));
+	size_t count = 0;
+	for(size_t polled = 1; os::is_event_replaying() || polled > 0;)
+	{
+		polled = os::poll_events(buffer.data() + count, buffer.size() - count);
+		count += polled;
+	}
+	os::set_event_mask(os::all_events);
+
+	UNIT_CHECK(count == 2);
+	UNIT_CHECK(buffer[0].type == os::events::key_down);
+	UNIT_CHECK(buffer[1].type == os::events::key_up);
+	std::remove(path);
+}
@@ -0,0 +1,125 @@
+#include "unit.hpp"
+
+#include <ospp/event.h>
+#include <ospp/event_dispatch.hpp>
+
+#include <array>
+#include <vector>
+
+namespace
+{
+std::array<os::event, 64> buffer{};
+std::vector<int> calls;
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+void dispatch(os::events type)
+{
+	os::event e{};
+	e.type = type;
+	os::detail::dispatch_event(e);
+}
+
+// The user pointer carries the number logged for each call
+auto log(void* user) -> int
+{
+	const int id = *static_cast<int*>(user);
+	calls.push_back(id);
+	return id;
+}
+
+int first_id = 1;
+int second_id = 2;
+int third_id = 3;
+
+auto logging_watch(const os::event&, void* user) -> bool
+{
+	log(user);
+	return false;
+}
+
+auto consuming_watch(const os::event& e, void* user) -> bool
+{
+	log(user);
+	return e.type == os::events::key_down;
+}
+
+auto removing_watch(const os::event&, void* user) -> bool
+{
+	log(user);
+	os::remove_event_watch(&removing_watch, user);
+	os::remove_event_watch(&logging_watch, &third_id);
+	return false;
+}
+} // namespace
+
+UNIT_TEST(event_watches_run_in_order_and_consume)
+{
+	discard_pending();
+	calls.clear();
+	UNIT_CHECK(os::add_event_watch(&logging_watch, &first_id));
+	UNIT_CHECK(os::add_event_watch(&consuming_watch, &second_id));
+	UNIT_CHECK(os::add_event_watch(&logging_watch, &third_id));
+
+	// the consumed event skips the later watches and the queue
+	dispatch(os::events::key_down);
+	dispatch(os::events::key_up);
+	UNIT_CHECK((calls == std::vector<int>{1, 2, 1, 2, 3}));
+	UNIT_CHECK(os::poll_events(buffer.data(), buffer.size()) == 1);
+	UNIT_CHECK(buffer[0].type == os::events::key_up);
+
+	// pushed events are not watched
+	calls.clear();
+	os::event pushed{};
+	pushed.type = os::events::key_down;
+	os::push_event(pushed);
+	UNIT_CHECK(calls.empty());
+	UNIT_CHECK(os::poll_events(buffer.data(), buffer.size()) == 1);
+
+	os::remove_event_watch(&logging_watch, &first_id);
+	os::remove_event_watch(&consuming_watch, &second_id);
+	os::remove_event_watch(&logging_watch, &third_id);
+	dispatch(os::events::key_down);
+	UNIT_CHECK(calls.empty());
+	discard_pending();
+}
+
+UNIT_TEST(event_watch_can_remove_watches_from_inside)
+{
+	discard_pending();
+	calls.clear();
+	UNIT_CHECK(os::add_event_watch(&removing_watch, &first_id));
+	UNIT_CHECK(os::add_event_watch(&logging_watch, &second_id));
+	UNIT_CHECK(os::add_event_watch(&logging_watch, &third_id));
+
+	// the first watch removes itself and the third, which then does not run
+	dispatch(os::events::key_down);
+	UNIT_CHECK((calls == std::vector<int>{1, 2}));
+
+	calls.clear();
+	dispatch(os::events::key_up);
+	UNIT_CHECK((calls == std::vector<int>{2}));
+	UNIT_CHECK(os::poll_events(buffer.data(), buffer.size()) == 2);
+
+	// the removed slots are free again
+	for(size_t i = 1; i < os::max_event_watches; ++i)
+	{
+		UNIT_CHECK(os::add_event_watch(&consuming_watch, &third_id));
+	}
+	UNIT_CHECK(!os::add_event_watch(&consuming_watch, &third_id));
+	for(size_t i = 1; i < os::max_event_watches; ++i)
+	{
+		os::remove_event_watch(&consuming_watch, &third_id);
+	}
+	os::remove_event_watch(&logging_watch, &second_id);
+
+	calls.clear();
+	dispatch(os::events::key_down);
+	UNIT_CHECK(calls.empty());
+	discard_pending();
+}
@@ -0,0 +1,96 @@
+#include "unit.hpp"
+
+#include <ospp/event.h>
+#include <ospp/event_dispatch.hpp>
+#include <ospp/keyboard.h>
+
+#include <array>
+
+namespace
+{
+void discard_pending()
+{
+	std::array<os::event, 64> buffer{};
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+void dispatch_key(os::events type, os::key::code code)
+{
+	os::event e{};
+	e.type = type;
+	e.key.code = code;
+	os::detail::dispatch_event(e);
+}
+
+void dispatch_focus_lost()
+{
+	os::event e{};
+	e.type = os::events::window;
+	e.window.type = os::window_event_id::focus_lost;
+	os::detail::dispatch_event(e);
+}
+
+// Other tests leave keys held, losing the focus releases all of them
+void reset_key_state()
+{
+	dispatch_focus_lost();
+	discard_pending();
+	os::key::get_state();
+}
+} // namespace
+
+UNIT_TEST(key_state_tracks_presses_per_frame)
+{
+	reset_key_state();
+	dispatch_key(os::events::key_down, os::key::code::a);
+	dispatch_key(os::events::key_down, os::key::code::space);
+	dispatch_key(os::events::key_up, os::key::code::space);
+	discard_pending();
+
+	// pressed and released within the frame shows up in both masks
+	auto state = os::key::get_state();
+	UNIT_CHECK(state.is_down(os::key::code::a) && state.is_just_pressed(os::key::code::a));
+	UNIT_CHECK(!state.is_just_released(os::key::code::a));
+	UNIT_CHECK(!state.is_down(os::key::code::space));
+	UNIT_CHECK(state.is_just_pressed(os::key::code::space) && state.is_just_released(os::key::code::space));
+	UNIT_CHECK(!state.is_down(os::key::code::b));
+
+	// the next frame keeps the held key without the transitions, repeats
+	// don't press it again
+	dispatch_key(os::events::key_down, os::key::code::a);
+	state = os::key::get_state();
+	UNIT_CHECK(state.is_down(os::key::code::a) && !state.is_just_pressed(os::key::code::a));
+	UNIT_CHECK(!state.is_just_pressed(os::key::code::space) && !state.is_just_released(os::key::code::space));
+
+	dispatch_key(os::events::key_up, os::key::code::a);
+	state = os::key::get_state();
+	UNIT_CHECK(!state.is_down(os::key::code::a) && state.is_just_released(os::key::code::a));
+	discard_pending();
+}
+
+UNIT_TEST(key_state_releases_held_keys_on_focus_lost)
+{
+	reset_key_state();
+	dispatch_key(os::events::key_down, os::key::code::lshift);
+	dispatch_key(os::events::key_down, os::key::code::w);
+	os::key::get_state();
+
+	dispatch_focus_lost();
+	const auto state = os::key::get_state();
+	UNIT_CHECK(!state.is_down(os::key::code::lshift) && state.is_just_released(os::key::code::lshift));
+	UNIT_CHECK(!state.is_down(os::key::code::w) && state.is_just_released(os::key::code::w));
+	discard_pending();
+}
+
+UNIT_TEST(key_state_ignores_pushed_events)
+{
+	reset_key_state();
+	os::event e{};
+	e.type = os::events::key_down;
+	e.key.code = os::key::code::a;
+	os::push_event(e);
+	discard_pending();
+	UNIT_CHECK(!os::key::get_state().is_down(os::key::code::a));
+}
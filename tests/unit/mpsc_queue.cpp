@@ -0,0 +1,124 @@
+#include "unit.hpp"
+
+#include <ospp/mpsc_queue.hpp>
+
+#include <thread>
+#include <vector>
+
+UNIT_TEST(mpsc_queue_starts_empty)
+{
+	os::detail::mpsc_queue<int, 4> queue;
+	int value = 0;
+	UNIT_CHECK(queue.empty());
+	UNIT_CHECK(queue.size() == 0);
+	UNIT_CHECK(!queue.try_pop(value));
+	UNIT_CHECK(queue.try_pop_bulk(&value, 1) == 0);
+}
+
+UNIT_TEST(mpsc_queue_rejects_pushes_when_full)
+{
+	os::detail::mpsc_queue<int, 4> queue;
+	for(int i = 0; i < 4; ++i)
+	{
+		UNIT_CHECK(queue.try_push(i));
+	}
+	UNIT_CHECK(queue.size() == 4);
+	UNIT_CHECK(!queue.try_push(4));
+
+	int value = -1;
+	UNIT_CHECK(queue.try_pop(value) && value == 0);
+	UNIT_CHECK(queue.try_push(4));
+	UNIT_CHECK(!queue.try_push(5));
+
+	for(int expected = 1; expected <= 4; ++expected)
+	{
+		UNIT_CHECK(queue.try_pop(value) && value == expected);
+	}
+	UNIT_CHECK(queue.empty());
+	UNIT_CHECK(!queue.try_pop(value));
+}
+
+UNIT_TEST(mpsc_queue_keeps_order_across_wraparound)
+{
+	os::detail::mpsc_queue<int, 4> queue;
+	int next_push = 0;
+	int next_pop = 0;
+
+	// three in, two out per lap, so the ring position drifts every lap
+	for(int lap = 0; lap < 21; ++lap)
+	{
+		while(queue.size() < 3)
+		{
+			UNIT_CHECK(queue.try_push(next_push++));
+		}
+		for(int i = 0; i < 2; ++i)
+		{
+			int value = -1;
+			UNIT_CHECK(queue.try_pop(value) && value == next_pop++);
+		}
+	}
+
+	// a bulk pop whose run wraps around the end of the ring
+	while(queue.try_push(next_push))
+	{
+		++next_push;
+	}
+	UNIT_CHECK(queue.popped() % 4 != 0);
+	int values[4] = {};
+	const size_t count = queue.try_pop_bulk(values, 4);
+	UNIT_CHECK(count == 4);
+	for(size_t i = 0; i < count; ++i)
+	{
+		UNIT_CHECK(values[i] == next_pop++);
+	}
+	UNIT_CHECK(queue.empty());
+	UNIT_CHECK(queue.pushed() == queue.popped());
+}
+
+UNIT_TEST(mpsc_queue_delivers_every_producer_in_order)
+{
+	constexpr int producers = 4;
+	constexpr int per_producer = 20000;
+	static os::detail::mpsc_queue<int, 64> queue;
+
+	std::vector<std::thread> threads;
+	for(int p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([p]() {
+			for(int i = 0; i < per_producer; ++i)
+			{
+				while(!queue.try_push(p * per_producer + i))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<int> next(producers, 0);
+	bool ordered = true;
+	for(int received = 0; received < producers * per_producer;)
+	{
+		int value = 0;
+		if(!queue.try_pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		const int p = value / per_producer;
+		ordered = ordered && value % per_producer == next[p];
+		++next[p];
+		++received;
+	}
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	UNIT_CHECK(ordered);
+	for(int p = 0; p < producers; ++p)
+	{
+		UNIT_CHECK(next[p] == per_producer);
+	}
+	UNIT_CHECK(queue.empty());
+}
@@ -0,0 +1,144 @@
+#include "unit.hpp"
+
+#include <ospp/event.h>
+#include <ospp/event_arena.hpp>
+#include <ospp/event_dispatch.hpp>
+#include <ospp/recording.h>
+
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr const char* path = "ospp_unit_recording.bin";
+
+std::array<os::event, 64> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+// Payloads only live until the next poll, so they are copied out right away
+struct replayed_event
+{
+	os::event e;
+	std::string source;
+	std::string data;
+};
+
+auto replay_all() -> std::vector<replayed_event>
+{
+	std::vector<replayed_event> replayed;
+	for(size_t count = 1; os::is_event_replaying() || count > 0;)
+	{
+		count = os::poll_events(buffer.data(), buffer.size());
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto& e = buffer[i];
+			replayed_event copy{e, {}, {}};
+			if(e.type == os::events::text_input)
+			{
+				copy.data = e.text.text.to_string();
+			}
+			else if(e.type == os::events::drop_file)
+			{
+				copy.source = e.drop.source.to_string();
+				copy.data = e.drop.data.to_string();
+			}
+			replayed.push_back(copy);
+		}
+	}
+	return replayed;
+}
+} // namespace
+
+UNIT_TEST(recording_round_trips_through_replay)
+{
+	discard_pending();
+	UNIT_CHECK(!os::is_event_recording());
+	UNIT_CHECK(os::start_event_recording(path));
+	UNIT_CHECK(os::is_event_recording());
+
+	auto& arena = os::detail::get_event_arena();
+	os::event motion{};
+	motion.type = os::events::mouse_motion;
+	motion.timestamp = 1000000;
+	motion.motion.window_id = 3;
+	motion.motion.x = 10.5f;
+	motion.motion.y = 20.25f;
+	motion.motion.xrel = -1.5f;
+	os::detail::dispatch_event(motion);
+
+	os::event key{};
+	key.type = os::events::key_down;
+	key.timestamp = 3000000;
+	key.key.window_id = 3;
+	key.key.code = os::key::code::space;
+	key.key.shift = true;
+	os::detail::dispatch_event(key);
+
+	os::event text{};
+	text.type = os::events::text_input;
+	text.timestamp = 4000000;
+	text.text.window_id = 3;
+	text.text.text = arena.store("caf\xC3\xA9");
+	os::detail::dispatch_event(text);
+
+	os::event drop{};
+	drop.type = os::events::drop_file;
+	drop.timestamp = 9000000;
+	drop.drop.window_id = 3;
+	drop.drop.source = arena.store("files");
+	drop.drop.data = arena.store("/tmp/a b.txt");
+	os::detail::dispatch_event(drop);
+
+	os::stop_event_recording();
+	UNIT_CHECK(!os::is_event_recording());
+	discard_pending();
+
+	UNIT_CHECK(os::start_event_replay(path, os::replay_mode::as_fast_as_possible));
+	UNIT_CHECK(os::is_event_replaying());
+
+	// backend input is ignored while replaying
+	os::event ignored{};
+	ignored.type = os::events::key_up;
+	os::detail::dispatch_event(ignored);
+
+	const auto replayed = replay_all();
+	UNIT_CHECK(!os::is_event_replaying());
+	UNIT_CHECK(replayed.size() == 4);
+	if(replayed.size() == 4)
+	{
+		const auto& m = replayed[0].e;
+		UNIT_CHECK(m.type == os::events::mouse_motion && m.motion.window_id == 3);
+		UNIT_CHECK(m.motion.x == 10.5f && m.motion.y == 20.25f && m.motion.xrel == -1.5f);
+
+		const auto& k = replayed[1].e;
+		UNIT_CHECK(k.type == os::events::key_down && k.key.code == os::key::code::space);
+		UNIT_CHECK(k.key.shift && !k.key.ctrl);
+
+		UNIT_CHECK(replayed[2].e.type == os::events::text_input && replayed[2].e.text.window_id == 3);
+		UNIT_CHECK(replayed[2].data == "caf\xC3\xA9");
+
+		UNIT_CHECK(replayed[3].e.type == os::events::drop_file && replayed[3].e.drop.window_id == 3);
+		UNIT_CHECK(replayed[3].source == "files");
+		UNIT_CHECK(replayed[3].data == "/tmp/a b.txt");
+
+		// shifted to the replay's start, the spacing is kept
+		UNIT_CHECK(replayed[1].e.timestamp - m.timestamp == 2000000);
+		UNIT_CHECK(replayed[3].e.timestamp - m.timestamp == 8000000);
+	}
+	std::remove(path);
+}
+
+UNIT_TEST(recording_replay_rejects_missing_files)
+{
+	std::remove(path);
+	UNIT_CHECK(!os::start_event_replay(path));
+	UNIT_CHECK(!os::is_event_replaying());
+}
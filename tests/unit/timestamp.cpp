@@ -0,0 +1,60 @@
+#include "unit.hpp"
+
+#include <ospp/event.h>
+#include <ospp/event_dispatch.hpp>
+
+#include <array>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+std::array<os::event, 64> buffer{};
+
+void discard_pending()
+{
+	while(os::poll_events(buffer.data(), buffer.size()) > 0)
+	{
+	}
+}
+
+auto make_event(uint64_t timestamp) -> os::event
+{
+	os::event e{};
+	e.type = os::events::key_down;
+	e.timestamp = timestamp;
+	return e;
+}
+} // namespace
+
+UNIT_TEST(timestamp_now_is_monotonic)
+{
+	const auto before = os::now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	const auto after = os::now();
+	UNIT_CHECK(after - before >= 2000000);
+}
+
+UNIT_TEST(timestamp_is_set_when_queued)
+{
+	discard_pending();
+	const auto before = os::now();
+	os::push_event(make_event(0));
+	os::detail::dispatch_event(make_event(0));
+	const auto after = os::now();
+
+	UNIT_CHECK(os::poll_events(buffer.data(), buffer.size()) == 2);
+	UNIT_CHECK(buffer[0].timestamp >= before && buffer[0].timestamp <= after);
+	UNIT_CHECK(buffer[1].timestamp >= before && buffer[1].timestamp <= after);
+}
+
+UNIT_TEST(timestamp_given_by_the_sender_is_kept)
+{
+	discard_pending();
+	os::push_event(make_event(42));
+	os::detail::dispatch_event(make_event(43));
+
+	UNIT_CHECK(os::poll_events(buffer.data(), buffer.size()) == 2);
+	UNIT_CHECK(buffer[0].timestamp == 42);
+	UNIT_CHECK(buffer[1].timestamp == 43);
+}
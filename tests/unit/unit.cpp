@@ -0,0 +1,51 @@
+#include "unit.hpp"
+
+#include <cstdio>
+#include <vector>
+
+namespace unit
+{
+namespace
+{
+struct test
+{
+	const char* name;
+	test_function function;
+};
+
+auto get_tests() -> std::vector<test>&
+{
+	static std::vector<test> tests;
+	return tests;
+}
+
+size_t failed_checks = 0;
+} // namespace
+
+auto add_test(const char* name, test_function function) -> bool
+{
+	get_tests().push_back({name, function});
+	return true;
+}
+
+void report_failure(const char* file, int line, const char* expression)
+{
+	++failed_checks;
+	std::printf("%s:%d: check failed: %s\n", file, line, expression);
+}
+
+auto run_tests() -> size_t
+{
+	size_t failed_tests = 0;
+	for(const auto& t : get_tests())
+	{
+		const auto failed_before = failed_checks;
+		t.function();
+		const bool passed = failed_checks == failed_before;
+		std::printf("%-8s %s\n", passed ? "passed" : "FAILED", t.name);
+		failed_tests += passed ? 0 : 1;
+	}
+	std::printf("%zu of %zu tests failed\n", failed_tests, get_tests().size());
+	return failed_tests;
+}
+} // namespace unit
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+// Minimal registry for the unit tests run by `ospp_test --unit`. A test is a
+// function registered during static initialization by UNIT_TEST, a failed
+// UNIT_CHECK reports the expression and the test keeps going.
+
+namespace unit
+{
+using test_function = void (*)();
+
+auto add_test(const char* name, test_function function) -> bool;
+void report_failure(const char* file, int line, const char* expression);
+
+//-----------------------------------------------------------------------------
+/// Runs every registered test in registration order and returns the number
+/// of tests which failed.
+//-----------------------------------------------------------------------------
+auto run_tests() -> size_t;
+} // namespace unit
+
+#define UNIT_TEST(name)                                                                                    \
+	static void name();                                                                                    \
+	static const bool name##_registered = ::unit::add_test(#name, &name);                                  \
+	static void name()
+
+#define UNIT_CHECK(expression)                                                                             \
+	do                                                                                                     \
+	{                                                                                                      \
+		if(!(expression))                                                                                  \
+		{                                                                                                  \
+			::unit::report_failure(__FILE__, __LINE__, #expression);                                       \
+		}                                                                                                  \
+	} while(false)